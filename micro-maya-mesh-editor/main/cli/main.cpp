@@ -0,0 +1,261 @@
+#include "animationclip.h"
+#include "decimation.h"
+#include "halfedgemesh.h"
+#include "jointhierarchy.h"
+#include "meshhistory.h"
+#include "meshwriter.h"
+#include "objloader.h"
+#include "skeletonjson.h"
+#include "skinning.h"
+#include "subdivision.h"
+
+#include <QElapsedTimer>
+#include <QString>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+void printUsage(FILE *out) {
+    fprintf(out, "Usage: meshcli STEP...\n"
+           "Runs the steps in order on one mesh and reports, after each, the wall time,\n"
+           "the peak resident memory of the process and the mesh element counts.\n"
+           "\n"
+           "  load FILE.obj          Replace the mesh with an .obj file\n"
+           "  subdivide N            Catmull-Clark subdivision, N levels\n"
+           "  subdivide-face F [N]   Catmull-Clark subdivision of face F only, N levels (default 1)\n"
+           "  triangulate            Triangulate every face by ear clipping\n"
+           "  bind FILE.json [K]     Load a skeleton and bind every vertex to its K nearest joints (default 2)\n"
+           "  animate CLIP.json [N]  Play a clip on the skeleton for N frames at 60 fps (default 60), leaving it posed\n"
+           "  method lbs|dq          Skin with linear blend skinning (the default) or dual quaternions\n"
+           "  skin [REPEAT]          Skin every vertex with the skeleton's pose on the CPU, REPEAT times (default 1),\n"
+           "                         and report the size of the palette uploaded to the GPU for that pose\n"
+           "  decimate TRIANGLES     Quadric edge-collapse decimation down to TRIANGLES triangles\n"
+           "  undo                   Undo the last subdivide or triangulate step of any kind\n"
+           "  redo                   Redo the last undone step\n"
+           "  write FILE [posed]     Write the mesh as .obj or binary .ply, with the skeleton's pose applied if posed\n"
+           "\n"
+           "Example: meshcli load ../../obj_files/cow.obj subdivide 3 triangulate write cow.obj\n"
+           "Compare skinning methods: meshcli load ../../obj_files/cow.obj subdivide 3 bind ../../jsons/cow_skeleton.json 4\n"
+           "                          skin 50 method dq skin 50\n");
+}
+
+// Peak resident set size of this process so far, in megabytes
+double peakMemoryMB() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+    return usage.ru_maxrss / 1024.0; // kilobytes
+#endif
+#endif
+}
+
+// Parse argv[i] as a positive integer, or use fallback if it is missing or not a number
+int intArgument(int argc, char *argv[], int &i, int fallback) {
+    if (i + 1 < argc) {
+        char *end;
+        long value = strtol(argv[i + 1], &end, 10);
+        if (*end == '\0' && value > 0) {
+            i++;
+            return value;
+        }
+    }
+    return fallback;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || !strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
+        printUsage(argc < 2 ? stderr : stdout);
+        return argc < 2 ? 1 : 0;
+    }
+
+    HalfEdgeMesh mesh;
+    MeshHistory history;
+    JointHierarchy skeleton;
+    std::vector<QString> jointNames;
+    QElapsedTimer total;
+    total.start();
+
+    printf("%-28s %12s %12s %10s %10s %10s\n", "step", "time (ms)", "peak (MB)", "verts", "half-edges", "faces");
+    for (int i = 1; i < argc; i++) {
+        std::string step = argv[i];
+        std::string label = step;
+        QElapsedTimer timer;
+        timer.start();
+
+        if (step == "load" && i + 1 < argc) {
+            label += std::string(" ") + argv[++i];
+            history.clear();
+            if (!ObjLoader::load(argv[i], mesh)) {
+                fprintf(stderr, "Could not load %s\n", argv[i]);
+                return 1;
+            }
+        } else if (step == "subdivide") {
+            int levels = intArgument(argc, argv, i, 1);
+            label += " " + std::to_string(levels);
+            history.begin(mesh);
+            history.saveAll();
+            mesh.subdivision(levels);
+            history.end();
+        } else if (step == "subdivide-face" && i + 1 < argc) {
+            uint32_t face = strtoul(argv[++i], nullptr, 10);
+            int levels = intArgument(argc, argv, i, 1);
+            label += " " + std::to_string(face) + " " + std::to_string(levels);
+            if (face >= mesh.numFaces()) {
+                fprintf(stderr, "No face %u in a mesh of %u faces\n", face, mesh.numFaces());
+                return 1;
+            }
+            std::vector<uint32_t> region = {face};
+            history.begin(mesh);
+            for (int level = 0; level < levels; level++) {
+                history.saveRegion(region);
+                mesh.subdivision(region);
+            }
+            history.end();
+        } else if (step == "triangulate") {
+            history.begin(mesh);
+            for (uint32_t face = 0; face < mesh.numFaces(); face++) {
+                if (mesh.faceDegree(face) > 3) history.saveFaceLoop(face);
+            }
+            mesh.triangulateAll();
+            history.end();
+        } else if (step == "bind" && i + 1 < argc) {
+            const char *path = argv[++i];
+            int influences = intArgument(argc, argv, i, 2);
+            label += std::string(" ") + path + " " + std::to_string(influences);
+            if (!SkeletonJson::load(QString::fromLocal8Bit(path), skeleton, jointNames)) {
+                fprintf(stderr, "Could not load %s\n", path);
+                return 1;
+            }
+            skeleton.bindPose();
+            std::vector<glm::vec3> jointPos;
+            for (const glm::mat4 &transformation : skeleton.getTransformations()) {
+                jointPos.push_back(glm::vec3(transformation[3]));
+            }
+            mesh.bindNearestJoints(jointPos, influences);
+            history.clear();
+        } else if (step == "animate" && i + 1 < argc) {
+            const char *path = argv[++i];
+            int frames = intArgument(argc, argv, i, 60);
+            label += std::string(" ") + path + " " + std::to_string(frames);
+            AnimationClip clip;
+            if (!SkeletonJson::loadClip(QString::fromLocal8Bit(path), jointNames, clip)) {
+                fprintf(stderr, "Could not load %s\n", path);
+                return 1;
+            }
+            QElapsedTimer animateTimer;
+            animateTimer.start();
+            for (int frame = 0; frame < frames; frame++) {
+                clip.sample(frame / 60.f, skeleton);
+                skeleton.getTransformations();
+            }
+            printf("  %d joints, %d tracks, %.3f ms per frame\n", skeleton.size(), clip.numTracks(),
+                   animateTimer.nsecsElapsed() * 1e-6 / frames);
+        } else if (step == "skin") {
+            int repeat = intArgument(argc, argv, i, 1);
+            label += " " + std::to_string(repeat);
+            if (skeleton.size() == 0) {
+                fprintf(stderr, "skin needs a bind step first\n");
+                return 1;
+            }
+            HalfEdgeMesh posed = mesh;
+            std::vector<glm::mat4> palette;
+            std::vector<DualQuat> dualQuats;
+            size_t paletteBytes;
+            if (mesh.skinningMethod == DUAL_QUATERNION) {
+                Skinning::buildDualQuatPalette(skeleton.getTransformations(), skeleton.bind, dualQuats);
+                paletteBytes = dualQuats.size() * sizeof(DualQuat);
+            } else {
+                Skinning::buildPalette(skeleton.getTransformations(), skeleton.bind, palette);
+                paletteBytes = palette.size() * sizeof(glm::mat4);
+            }
+            QElapsedTimer skinTimer;
+            skinTimer.start();
+            for (int r = 0; r < repeat; r++) {
+                if (mesh.skinningMethod == DUAL_QUATERNION) {
+                    Skinning::skin(mesh, dualQuats, posed);
+                } else {
+                    Skinning::skin(mesh, palette, posed);
+                }
+            }
+            double seconds = std::max<qint64>(1, skinTimer.nsecsElapsed()) * 1e-9;
+            printf("  %s, %.1f M vertices/s, %.1f ns per vertex, palette %zu bytes (%zu per joint)\n",
+                   mesh.skinningMethod == DUAL_QUATERNION ? "dual quaternion" : "linear blend",
+                   mesh.numVerts() * (double)repeat / seconds * 1e-6, seconds * 1e9 / (mesh.numVerts() * (double)repeat),
+                   paletteBytes, paletteBytes / std::max(1, skeleton.size()));
+        } else if (step == "method" && i + 1 < argc) {
+            std::string method = argv[++i];
+            label += " " + method;
+            if (method == "lbs") {
+                mesh.skinningMethod = LINEAR_BLEND;
+            } else if (method == "dq") {
+                mesh.skinningMethod = DUAL_QUATERNION;
+            } else {
+                fprintf(stderr, "Unknown skinning method \"%s\"\n", method.c_str());
+                return 1;
+            }
+        } else if (step == "decimate") {
+            int triangles = intArgument(argc, argv, i, 1000);
+            label += " " + std::to_string(triangles);
+            HalfEdgeMesh decimated;
+            Decimation::decimate(mesh, triangles, decimated);
+            std::swap(mesh, decimated);
+            history.clear();
+        } else if (step == "undo" || step == "redo") {
+            if (!(step == "undo" ? history.undo(mesh) : history.redo(mesh))) {
+                fprintf(stderr, "Nothing to %s\n", step.c_str());
+                return 1;
+            }
+            printf("  history holds %.1f KB\n", history.memoryUsage() / 1024.0);
+        } else if (step == "write" && i + 1 < argc) {
+            const char *path = argv[++i];
+            bool writePosed = i + 1 < argc && !strcmp(argv[i + 1], "posed");
+            if (writePosed) i++;
+            label += std::string(" ") + path + (writePosed ? " posed" : "");
+
+            HalfEdgeMesh posed;
+            if (writePosed) {
+                if (skeleton.size() == 0) {
+                    fprintf(stderr, "write posed needs a bind step first\n");
+                    return 1;
+                }
+                posed = mesh;
+                Skinning::pose(mesh, skeleton.getTransformations(), skeleton.bind, posed);
+            }
+            if (!MeshWriter::save(path, mesh, writePosed ? &posed : nullptr)) {
+                fprintf(stderr, "Could not write %s\n", path);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Unknown or incomplete step \"%s\"\n\n", argv[i]);
+            printUsage(stderr);
+            return 1;
+        }
+
+        printf("%-28s %12.2f %12.1f %10u %10u %10u\n", label.c_str(), timer.nsecsElapsed() * 1e-6,
+               peakMemoryMB(), mesh.numVerts(), mesh.numHalfEdges(), mesh.numFaces());
+    }
+    printf("%-28s %12.2f\n", "total", total.nsecsElapsed() * 1e-6);
+
+    return 0;
+}
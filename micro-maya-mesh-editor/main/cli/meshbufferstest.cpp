@@ -0,0 +1,140 @@
+#include "meshbuffers.h"
+#include "objloader.h"
+
+#include <cstdio>
+#include <vector>
+
+// Checks that uploading only the ranges returned by MeshBuffers::rebuildDirty() leaves the
+// VBOs equal to a full build(), for position and color edits in flat and smooth mode.
+// Vertex and face indices are taken modulo the mesh size, so any .obj will do.
+// Also checks that the skinning method and the skin of a bound mesh survive a subdivision.
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char *what, const char *mode, int round, uint32_t entry) {
+    if (ok) return;
+    if (failures < 20) fprintf(stderr, "FAIL %s mode, round %d: %s at entry %u\n", mode, round, what, entry);
+    failures++;
+}
+
+// What the GPU holds: copy the attributes of each range from the CPU arrays
+void upload(std::vector<glm::vec4> &gpu, const std::vector<glm::vec4> &cpu,
+            const std::vector<MeshBuffers::CornerRange> &ranges, int attribute) {
+    for (const MeshBuffers::CornerRange &range : ranges) {
+        if (!(range.attributes & attribute)) continue;
+        for (uint32_t i = range.begin; i < range.end; i++) gpu[i] = cpu[i];
+    }
+}
+
+void compare(const std::vector<glm::vec4> &a, const std::vector<glm::vec4> &b,
+             const char *what, const char *mode, int round) {
+    check(a.size() == b.size(), what, mode, round, 0);
+    for (uint32_t i = 0; i < a.size() && i < b.size(); i++) check(a[i] == b[i], what, mode, round, i);
+}
+
+void run(HalfEdgeMesh mesh, bool smooth, uint32_t mergeGap) {
+    const char *mode = smooth ? "smooth" : "flat";
+    const uint32_t numVerts = mesh.numVerts();
+    const uint32_t numFaces = mesh.numFaces();
+
+    MeshBuffers buffers;
+    buffers.smooth = smooth;
+    buffers.build(mesh);
+    std::vector<glm::vec4> gpuPositions = buffers.positions;
+    std::vector<glm::vec4> gpuNormals = buffers.normals;
+    std::vector<glm::vec4> gpuColors = buffers.colors;
+
+    // Positions only, colors only, then both
+    for (int round = 0; round < 24; round++) {
+        if (round % 3 != 1) {
+            for (uint32_t i = 0; i < 2; i++) {
+                uint32_t vert = (round * 7 + i * 13 + 1) % numVerts;
+                mesh.posX[vert] += 0.25f * (i + 1);
+                mesh.posY[vert] -= 0.125f * round;
+                buffers.markVertex(mesh, vert);
+            }
+        }
+        if (round % 3 != 0) {
+            uint32_t face = (round * 5 + 2) % numFaces;
+            mesh.faceColor[face] = glm::vec3((round % 4) / 4.f, 0.5f, 1.f - (round % 5) / 5.f);
+            buffers.markFace(face);
+        }
+
+        std::vector<MeshBuffers::CornerRange> ranges = buffers.rebuildDirty(mesh, mergeGap);
+        for (size_t i = 0; i < ranges.size(); i++) {
+            check(ranges[i].begin < ranges[i].end && ranges[i].end <= buffers.positions.size(),
+                  "range out of bounds", mode, round, ranges[i].begin);
+            check(i == 0 || ranges[i - 1].end <= ranges[i].begin, "ranges not sorted", mode, round, ranges[i].begin);
+        }
+        upload(gpuPositions, buffers.positions, ranges, MeshBuffers::POSITION);
+        upload(gpuNormals, buffers.normals, ranges, MeshBuffers::NORMAL);
+        upload(gpuColors, buffers.colors, ranges, MeshBuffers::COLOR);
+
+        MeshBuffers full;
+        full.smooth = smooth;
+        full.build(mesh);
+        compare(buffers.positions, full.positions, "position", mode, round);
+        compare(buffers.normals, full.normals, "normal", mode, round);
+        compare(buffers.colors, full.colors, "color", mode, round);
+        compare(gpuPositions, full.positions, "uploaded position", mode, round);
+        compare(gpuNormals, full.normals, "uploaded normal", mode, round);
+        compare(gpuColors, full.colors, "uploaded color", mode, round);
+        check(!buffers.isDirty(), "still dirty", mode, round, 0);
+    }
+}
+
+// Subdivision builds a new mesh and swaps it in, which must not reset the skinning method
+void checkSubdivision(HalfEdgeMesh mesh) {
+    for (SkinningMethod method : {LINEAR_BLEND, DUAL_QUATERNION}) {
+        mesh.skinningMethod = method;
+        mesh.subdivision(1);
+        check(mesh.skinningMethod == method, "subdivision changed the skinning method",
+              method == DUAL_QUATERNION ? "dual quaternion" : "linear blend", 0, 0);
+        mesh.subdivision(2);
+        check(mesh.skinningMethod == method, "subdivision changed the skinning method",
+              method == DUAL_QUATERNION ? "dual quaternion" : "linear blend", 1, 0);
+    }
+}
+
+// Vertices inserted into a bound mesh must be bound too, or the skeleton shaders would leave
+// them in the rest pose while their neighbors follow the joints
+void checkSkinnedSubdivision(HalfEdgeMesh mesh) {
+    mesh.bindNearestJoints({glm::vec3(-1.f, 0.f, 0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(0.f, 2.f, 0.f)}, 2);
+    mesh.splitEdge(0);
+    std::vector<uint32_t> faces = {0};
+    mesh.subdivision(faces, 1);
+    mesh.subdivision(1);
+    for (uint32_t vert = 0; vert < mesh.numVerts(); vert++) {
+        const SkinInfluences &skin = mesh.vertSkin[vert];
+        int sum = 0;
+        for (int i = 0; i < SkinInfluences::MAX; i++) sum += skin.weight[i];
+        check(sum == 65535, "new vertex not bound", "bound", 0, vert);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const char *path = argc > 1 ? argv[1] : "../../obj_files/cube.obj";
+    HalfEdgeMesh mesh;
+    if (!ObjLoader::load(path, mesh) || mesh.numVerts() == 0) {
+        fprintf(stderr, "Usage: meshbufferstest [FILE.obj]\nCould not load %s\n", path);
+        return 2;
+    }
+
+    for (uint32_t mergeGap : {0u, 64u}) {
+        run(mesh, false, mergeGap);
+        run(mesh, true, mergeGap);
+    }
+    checkSubdivision(mesh);
+    checkSkinnedSubdivision(mesh);
+
+    if (failures) {
+        fprintf(stderr, "%d failures\n", failures);
+        return 1;
+    }
+    printf("meshbufferstest: %u verts, %u faces, flat and smooth OK\n", mesh.numVerts(), mesh.numFaces());
+    return 0;
+}
@@ -0,0 +1,40 @@
+# Checks the partial VBO updates of MeshBuffers against a full rebuild, and that subdivision
+# keeps the skinning method of the mesh, without Qt or OpenGL.
+# "make check" runs it on cube.obj, any other .obj can be passed as the only argument.
+QT =
+CONFIG -= qt app_bundle
+CONFIG += console c++1z testcase
+
+TARGET = meshbufferstest
+TEMPLATE = app
+
+INCLUDEPATH += ../src ../include
+# Every translation unit sees the same GLM, taking angles in radians
+DEFINES += GLM_FORCE_RADIANS
+
+TESTARGS = $$PWD/../../obj_files/cube.obj
+
+SOURCES += \
+    meshbufferstest.cpp \
+    ../src/halfedgemesh.cpp \
+    ../src/kdtree.cpp \
+    ../src/meshbuffers.cpp \
+    ../src/objloader.cpp \
+    ../src/subdivision.cpp \
+    ../src/triangulation.cpp
+
+HEADERS += \
+    ../src/halfedgemesh.h \
+    ../src/kdtree.h \
+    ../src/meshbuffers.h \
+    ../src/objloader.h \
+    ../src/parallel.h \
+    ../src/subdivision.h \
+    ../src/triangulation.h
+
+*-clang*|*-g++* {
+    QMAKE_CXXFLAGS += -Wall -Wextra -pedantic
+}
+unix:!macx {
+    LIBS += -pthread
+}
@@ -0,0 +1,52 @@
+# Command line front end to the mesh operations of the editor, without any GUI or OpenGL.
+# Runs a scripted sequence of steps and reports time, peak memory and element counts after each.
+QT = core
+
+TARGET = meshcli
+TEMPLATE = app
+CONFIG += console c++1z
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../src ../include
+# Every translation unit sees the same GLM, taking angles in radians
+DEFINES += GLM_FORCE_RADIANS
+
+SOURCES += \
+    main.cpp \
+    ../src/animationclip.cpp \
+    ../src/decimation.cpp \
+    ../src/halfedgemesh.cpp \
+    ../src/jointhierarchy.cpp \
+    ../src/kdtree.cpp \
+    ../src/meshhistory.cpp \
+    ../src/meshwriter.cpp \
+    ../src/objloader.cpp \
+    ../src/skeletonjson.cpp \
+    ../src/skinning.cpp \
+    ../src/subdivision.cpp \
+    ../src/triangulation.cpp
+
+HEADERS += \
+    ../src/animationclip.h \
+    ../src/decimation.h \
+    ../src/halfedgemesh.h \
+    ../src/jointhierarchy.h \
+    ../src/kdtree.h \
+    ../src/meshhistory.h \
+    ../src/meshwriter.h \
+    ../src/objloader.h \
+    ../src/parallel.h \
+    ../src/skeletonjson.h \
+    ../src/skinning.h \
+    ../src/subdivision.h \
+    ../src/triangulation.h
+
+*-clang*|*-g++* {
+    QMAKE_CXXFLAGS += -Wall -Wextra -pedantic
+}
+unix:!macx {
+    LIBS += -pthread
+}
+win32 {
+    LIBS += -lpsapi
+}
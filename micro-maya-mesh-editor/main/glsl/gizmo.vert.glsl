@@ -0,0 +1,35 @@
+#version 330 core
+
+// Joint gizmos drawn with glDrawElementsInstanced, one instance per joint. Joint gl_InstanceID's
+// record in u_Instances is six RGBA32F texels: its world matrix by columns, the position of its
+// parent and a tint that replaces the axis colors of the circles when its alpha is 1.
+
+uniform mat4 u_ViewProj;
+uniform samplerBuffer u_Instances;
+
+in vec4 vs_Pos; // w = 1 for a circle point in the joint's frame, w = 0 for an end of the link to the parent
+in vec4 vs_Col;
+
+out vec4 fs_Col;
+
+void main()
+{
+    int base = gl_InstanceID * 6;
+    mat4 world = mat4(texelFetch(u_Instances, base),
+                      texelFetch(u_Instances, base + 1),
+                      texelFetch(u_Instances, base + 2),
+                      texelFetch(u_Instances, base + 3));
+    vec4 parentPos = texelFetch(u_Instances, base + 4);
+    vec4 tint = texelFetch(u_Instances, base + 5);
+
+    vec4 worldPos;
+    if (vs_Pos.w == 1.0) {
+        worldPos = world * vs_Pos;
+        fs_Col = tint.a == 1.0 ? tint : vs_Col;
+    } else {
+        worldPos = vec4(mix(world[3].xyz, parentPos.xyz, vs_Pos.x), 1.0);
+        fs_Col = vs_Col;
+    }
+
+    gl_Position = u_ViewProj * worldPos;
+}
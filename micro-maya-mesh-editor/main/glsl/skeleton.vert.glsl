@@ -2,24 +2,39 @@
 
 uniform mat4 u_Model;
 uniform mat4 u_ViewProj;
-uniform mat4 u_Transformations[100];
-uniform mat4 u_Binds[100];
+// transformation * bind of every joint, four texels (columns) per joint
+uniform samplerBuffer u_Palette;
 
 in vec4 vs_Pos;
 in vec4 vs_Col;
-in ivec2 vs_Joints;
-in vec2 vs_Weights;
+in uvec4 vs_Joints;
+in vec4 vs_Weights;
 
 out vec4 fs_Col;
 
+mat4 paletteMatrix(int joint)
+{
+    int texel = joint * 4;
+    return mat4(texelFetch(u_Palette, texel),
+                texelFetch(u_Palette, texel + 1),
+                texelFetch(u_Palette, texel + 2),
+                texelFetch(u_Palette, texel + 3));
+}
+
 void main(void)
 {
     fs_Col = vs_Col;
 
-    vec4 pos1 = u_Transformations[vs_Joints[0]] * u_Binds[vs_Joints[0]] * vs_Pos;
-    vec4 pos2 = u_Transformations[vs_Joints[1]] * u_Binds[vs_Joints[1]] * vs_Pos;
+    mat4 skin = vs_Weights[0] * paletteMatrix(int(vs_Joints[0]))
+              + vs_Weights[1] * paletteMatrix(int(vs_Joints[1]))
+              + vs_Weights[2] * paletteMatrix(int(vs_Joints[2]))
+              + vs_Weights[3] * paletteMatrix(int(vs_Joints[3]));
+    // Like the CPU skinning, vertices bound to no joint keep their rest position
+    if (vs_Weights[0] == 0.0) {
+        skin = mat4(1.0);
+    }
 
-    vec4 modelposition = u_Model * vs_Weights[0] * pos1 + vs_Weights[1] * pos2;
+    vec4 modelposition = u_Model * skin * vs_Pos;
 
     gl_Position = u_ViewProj * modelposition;
 }
@@ -0,0 +1,47 @@
+#version 330 core
+
+uniform mat4 u_Model;
+uniform mat4 u_ViewProj;
+// transformation * bind of every joint as a dual quaternion, its real then its dual part
+uniform samplerBuffer u_Palette;
+
+in vec4 vs_Pos;
+in vec4 vs_Col;
+in uvec4 vs_Joints;
+in vec4 vs_Weights;
+
+out vec4 fs_Col;
+
+void main(void)
+{
+    fs_Col = vs_Col;
+
+    // q and -q are the same rotation but would cancel out when blended,
+    // so every influence is flipped to the side of the first one
+    vec4 pivot = texelFetch(u_Palette, int(vs_Joints[0]) * 2);
+    vec4 real = vec4(0.0);
+    vec4 dual = vec4(0.0);
+    for (int i = 0; i < 4; i++) {
+        int texel = int(vs_Joints[i]) * 2;
+        vec4 jointReal = texelFetch(u_Palette, texel);
+        float weight = dot(pivot, jointReal) < 0.0 ? -vs_Weights[i] : vs_Weights[i];
+        real += weight * jointReal;
+        dual += weight * texelFetch(u_Palette, texel + 1);
+    }
+    // Like the CPU skinning, vertices bound to no joint keep their rest position
+    if (vs_Weights[0] == 0.0) {
+        real = vec4(0.0, 0.0, 0.0, 1.0);
+        dual = vec4(0.0);
+    }
+
+    // Normalizing the blend divides both parts by the length of real, every product
+    // of two parts below is divided by its square instead
+    float scale = 2.0 / max(dot(real, real), 1e-20);
+    vec3 p = vs_Pos.xyz;
+    vec3 rotation = cross(real.xyz, cross(real.xyz, p) + real.w * p);
+    vec3 translation = real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz);
+
+    vec4 modelposition = u_Model * vec4(p + scale * (rotation + translation), 1.0);
+
+    gl_Position = u_ViewProj * modelposition;
+}
@@ -13,6 +13,8 @@ CONFIG += warn_on
 CONFIG += debug
 
 INCLUDEPATH += include
+# Every translation unit sees the same GLM, taking angles in radians
+DEFINES += GLM_FORCE_RADIANS
 
 include(src/src.pri)
 
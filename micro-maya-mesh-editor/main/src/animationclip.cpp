@@ -0,0 +1,197 @@
+#include "animationclip.h"
+#include <algorithm>
+#include <cmath>
+
+void AnimationClip::Batch::resize(int size) {
+    for (std::vector<float> *component : {&ax, &ay, &az, &aw, &bx, &by, &bz, &bw, &weight}) {
+        component->resize(size);
+    }
+    valid.resize(size);
+}
+
+AnimationClip::AnimationClip()
+    : name(), duration(0.f), loop(true), cacheFps(0.f), cacheFrames(0)
+{
+    clear();
+}
+
+void AnimationClip::clear() {
+    trackJoint.clear();
+    posFirst.assign(1, 0);
+    posTimes.clear();
+    posKeys.clear();
+    rotFirst.assign(1, 0);
+    rotTimes.clear();
+    rotKeys.clear();
+    duration = 0.f;
+    clearCache();
+}
+
+int AnimationClip::addTrack(int joint) {
+    trackJoint.push_back(joint);
+    posFirst.push_back(posKeys.size());
+    rotFirst.push_back(rotKeys.size());
+    clearCache();
+    return trackJoint.size() - 1;
+}
+
+// A key goes at the end of its track's range, which moves the ranges of the later tracks by one
+void AnimationClip::addPositionKey(int track, float time, const glm::vec3 &position) {
+    uint32_t at = posFirst[track + 1];
+    posTimes.insert(posTimes.begin() + at, time);
+    posKeys.insert(posKeys.begin() + at, position);
+    for (size_t t = track + 1; t < posFirst.size(); t++) posFirst[t]++;
+    duration = std::max(duration, time);
+    clearCache();
+}
+
+void AnimationClip::addRotationKey(int track, float time, const glm::quat &rotation) {
+    uint32_t at = rotFirst[track + 1];
+    rotTimes.insert(rotTimes.begin() + at, time);
+    rotKeys.insert(rotKeys.begin() + at, glm::normalize(rotation));
+    for (size_t t = track + 1; t < rotFirst.size(); t++) rotFirst[t]++;
+    duration = std::max(duration, time);
+    clearCache();
+}
+
+float AnimationClip::wrap(float time) const {
+    if (duration <= 0.f) return 0.f;
+    if (!loop) return std::min(std::max(time, 0.f), duration);
+    time = std::fmod(time, duration);
+    return time < 0.f ? time + duration : time;
+}
+
+void AnimationClip::gather(float time, const std::vector<uint32_t> &first, const std::vector<float> &times,
+                           const float *keys, int stride, Batch &batch) {
+    const int numTracks = first.size() - 1;
+    for (int t = 0; t < numTracks; t++) {
+        uint32_t begin = first[t];
+        uint32_t end = first[t + 1];
+        batch.valid[t] = begin < end;
+        if (begin == end) continue;
+
+        // The first key after time, and the one before it, clamped to the track's range
+        uint32_t next = std::upper_bound(times.begin() + begin, times.begin() + end, time) - times.begin();
+        uint32_t b = std::min(next, end - 1);
+        uint32_t a = next > begin ? next - 1 : begin;
+        float span = times[b] - times[a];
+        batch.weight[t] = span > 0.f ? (time - times[a]) / span : 0.f;
+
+        const float *keyA = keys + a * stride;
+        const float *keyB = keys + b * stride;
+        batch.ax[t] = keyA[0]; batch.ay[t] = keyA[1]; batch.az[t] = keyA[2];
+        batch.bx[t] = keyB[0]; batch.by[t] = keyB[1]; batch.bz[t] = keyB[2];
+        batch.aw[t] = stride == 4 ? keyA[3] : 0.f;
+        batch.bw[t] = stride == 4 ? keyB[3] : 0.f;
+    }
+}
+
+void AnimationClip::blend(Batch &batch, bool quaternions) {
+    const int size = batch.weight.size();
+    float *ax = batch.ax.data(), *ay = batch.ay.data(), *az = batch.az.data(), *aw = batch.aw.data();
+    const float *bx = batch.bx.data(), *by = batch.by.data(), *bz = batch.bz.data(), *bw = batch.bw.data();
+    const float *weight = batch.weight.data();
+
+    if (!quaternions) {
+        for (int t = 0; t < size; t++) {
+            ax[t] += (bx[t] - ax[t]) * weight[t];
+            ay[t] += (by[t] - ay[t]) * weight[t];
+            az[t] += (bz[t] - az[t]) * weight[t];
+        }
+        return;
+    }
+
+    // Normalized lerp along the shorter arc, which for keys a frame apart is as good as a slerp
+    for (int t = 0; t < size; t++) {
+        float dot = ax[t] * bx[t] + ay[t] * by[t] + az[t] * bz[t] + aw[t] * bw[t];
+        float sign = dot < 0.f ? -1.f : 1.f;
+        float x = ax[t] + (sign * bx[t] - ax[t]) * weight[t];
+        float y = ay[t] + (sign * by[t] - ay[t]) * weight[t];
+        float z = az[t] + (sign * bz[t] - az[t]) * weight[t];
+        float w = aw[t] + (sign * bw[t] - aw[t]) * weight[t];
+        float invLength = 1.f / std::sqrt(std::max(x * x + y * y + z * z + w * w, 1e-20f));
+        ax[t] = x * invLength;
+        ay[t] = y * invLength;
+        az[t] = z * invLength;
+        aw[t] = w * invLength;
+    }
+}
+
+void AnimationClip::sampleBatches(float time) {
+    const int tracks = numTracks();
+    posBatch.resize(tracks);
+    rotBatch.resize(tracks);
+
+    if (!hasCache()) {
+        gather(time, posFirst, posTimes, reinterpret_cast<const float*>(posKeys.data()), 3, posBatch);
+        gather(time, rotFirst, rotTimes, reinterpret_cast<const float*>(rotKeys.data()), 4, rotBatch);
+    } else {
+        // Every track has a key on every frame, so the pair of keys and the weight are shared
+        float frame = time * cacheFps;
+        int a = std::min((int)frame, cacheFrames - 1);
+        int b = std::min(a + 1, cacheFrames - 1);
+        float weight = frame - a;
+        for (int t = 0; t < tracks; t++) {
+            const glm::vec3 &posA = cachePos[a * tracks + t];
+            const glm::vec3 &posB = cachePos[b * tracks + t];
+            const glm::quat &rotA = cacheRot[a * tracks + t];
+            const glm::quat &rotB = cacheRot[b * tracks + t];
+            posBatch.ax[t] = posA.x; posBatch.ay[t] = posA.y; posBatch.az[t] = posA.z;
+            posBatch.bx[t] = posB.x; posBatch.by[t] = posB.y; posBatch.bz[t] = posB.z;
+            rotBatch.ax[t] = rotA.x; rotBatch.ay[t] = rotA.y; rotBatch.az[t] = rotA.z; rotBatch.aw[t] = rotA.w;
+            rotBatch.bx[t] = rotB.x; rotBatch.by[t] = rotB.y; rotBatch.bz[t] = rotB.z; rotBatch.bw[t] = rotB.w;
+            posBatch.weight[t] = weight;
+            rotBatch.weight[t] = weight;
+            posBatch.valid[t] = posFirst[t] < posFirst[t + 1];
+            rotBatch.valid[t] = rotFirst[t] < rotFirst[t + 1];
+        }
+    }
+
+    blend(posBatch, false);
+    blend(rotBatch, true);
+}
+
+void AnimationClip::sample(float time, JointHierarchy &hierarchy) {
+    sampleBatches(wrap(time));
+
+    for (int t = 0; t < numTracks(); t++) {
+        int joint = trackJoint[t];
+        if (joint < 0 || joint >= hierarchy.size()) continue;
+        if (posBatch.valid[t]) {
+            hierarchy.setPosition(joint, glm::vec3(posBatch.ax[t], posBatch.ay[t], posBatch.az[t]));
+        }
+        if (rotBatch.valid[t]) {
+            hierarchy.setRotation(joint, glm::quat(rotBatch.aw[t], rotBatch.ax[t], rotBatch.ay[t], rotBatch.az[t]));
+        }
+    }
+}
+
+void AnimationClip::cachePoses(float fps) {
+    clearCache();
+    if (fps <= 0.f || numTracks() == 0) return;
+
+    // Frames run up to the end of the clip, so the last pose never blends into the first one
+    const int tracks = numTracks();
+    const int frames = (int)std::ceil(duration * fps) + 1;
+    std::vector<glm::vec3> pos(frames * tracks);
+    std::vector<glm::quat> rot(frames * tracks);
+    for (int f = 0; f < frames; f++) {
+        sampleBatches(std::min(f / fps, duration));
+        for (int t = 0; t < tracks; t++) {
+            pos[f * tracks + t] = glm::vec3(posBatch.ax[t], posBatch.ay[t], posBatch.az[t]);
+            rot[f * tracks + t] = glm::quat(rotBatch.aw[t], rotBatch.ax[t], rotBatch.ay[t], rotBatch.az[t]);
+        }
+    }
+
+    cachePos.swap(pos);
+    cacheRot.swap(rot);
+    cacheFrames = frames;
+    cacheFps = fps;
+}
+
+void AnimationClip::clearCache() {
+    cacheFps = 0.f;
+    cacheFrames = 0;
+    cachePos.clear();
+    cacheRot.clear();
+}
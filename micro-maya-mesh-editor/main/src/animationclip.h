@@ -0,0 +1,84 @@
+#ifndef ANIMATIONCLIP_H
+#define ANIMATIONCLIP_H
+
+#include "jointhierarchy.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Keyframed translation and rotation tracks over the joints of a JointHierarchy.
+// sample() poses every animated joint for a time in one batched pass: each track first looks up
+// its pair of keys and blend weight, then all tracks are blended together in loops over flat float
+// arrays that the compiler vectorizes. The hierarchy's forward update() then turns the local poses
+// into world transformations without any recursion.
+// cachePoses() resamples every track at a fixed rate, after which a sample needs no key search at all.
+class AnimationClip
+{
+public:
+    AnimationClip();
+
+    std::string name;
+    // Length of the clip in seconds, the time of its last key
+    float duration;
+    // Whether sample() wraps times past duration around, or holds the last pose
+    bool loop;
+
+    int numTracks() const { return trackJoint.size(); }
+
+    // Remove every track and key
+    void clear();
+
+    // Append an empty track driving joint, returns its index
+    int addTrack(int joint);
+    // Append a key to a track. Keys of a track must be added in increasing time order.
+    void addPositionKey(int track, float time, const glm::vec3 &position);
+    void addRotationKey(int track, float time, const glm::quat &rotation);
+
+    // Set the position and rotation of every animated joint to their value at time
+    void sample(float time, JointHierarchy &hierarchy);
+
+    // Resample every track fps times per second, so that sample() blends two cached poses instead
+    // of searching keys. Any edit to the clip drops the cache.
+    void cachePoses(float fps);
+    void clearCache();
+    bool hasCache() const { return cacheFps > 0.f; }
+
+private:
+    // Keys of every track in one array per channel, track t owns [first[t], first[t + 1])
+    std::vector<int> trackJoint;
+    std::vector<uint32_t> posFirst;
+    std::vector<float> posTimes;
+    std::vector<glm::vec3> posKeys;
+    std::vector<uint32_t> rotFirst;
+    std::vector<float> rotTimes;
+    std::vector<glm::quat> rotKeys;
+
+    // Cached poses, frame f holds the pose of every track at f / cacheFps
+    float cacheFps;
+    int cacheFrames;
+    std::vector<glm::vec3> cachePos;
+    std::vector<glm::quat> cacheRot;
+
+    // Per-track blend inputs gathered before the blend pass, one array per component
+    struct Batch {
+        std::vector<float> ax, ay, az, aw;
+        std::vector<float> bx, by, bz, bw;
+        std::vector<float> weight;
+        std::vector<char> valid;
+
+        void resize(int size);
+    };
+    Batch posBatch;
+    Batch rotBatch;
+
+    float wrap(float time) const;
+    // Gather the keys around time of every track for one channel
+    static void gather(float time, const std::vector<uint32_t> &first, const std::vector<float> &times,
+                       const float *keys, int stride, Batch &batch);
+    // out = a + (b - a) * weight for every track, then normalized if the channel holds quaternions
+    static void blend(Batch &batch, bool quaternions);
+    // Sample from the keys, or from the cache when there is one, into the batches' a components
+    void sampleBatches(float time);
+};
+
+#endif // ANIMATIONCLIP_H
@@ -65,6 +65,16 @@ glm::mat4 Camera::getViewProj()
     return glm::perspective(glm::radians(fovy), width / (float)height, near_clip, far_clip) * glm::lookAt(eye, ref, up);
 }
 
+void Camera::Raycast(float ndcX, float ndcY, glm::vec3 &origin, glm::vec3 &direction)
+{
+    // Unproject through the matrix used for drawing, so the ray matches what is on screen
+    glm::mat4 invViewProj = glm::inverse(getViewProj());
+    glm::vec4 nearPoint = invViewProj * glm::vec4(ndcX, ndcY, -1.f, 1.f);
+    glm::vec4 farPoint = invViewProj * glm::vec4(ndcX, ndcY, 1.f, 1.f);
+    origin = glm::vec3(nearPoint) / nearPoint.w;
+    direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+}
+
 void Camera::RotateAboutUp(float deg)
 {
 //    glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(deg), up);
@@ -36,6 +36,10 @@ public:
 
     glm::mat4 getViewProj();
 
+    // The world space ray through the point (ndcX, ndcY) of the screen, both in [-1, 1] with y up.
+    // It starts on the near clip plane.
+    void Raycast(float ndcX, float ndcY, glm::vec3 &origin, glm::vec3 &direction);
+
     void RecomputeAttributes();
 
     void RotateAboutUp(float deg);
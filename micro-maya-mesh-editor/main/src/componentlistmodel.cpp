@@ -0,0 +1,22 @@
+#include "componentlistmodel.h"
+
+ComponentListModel::ComponentListModel(QObject *parent)
+    : QAbstractListModel(parent), m_count(0)
+{}
+
+int ComponentListModel::rowCount(const QModelIndex &parent) const {
+    // A list has no children
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant ComponentListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_count) return QVariant();
+    if (role == Qt::DisplayRole) return QString::number(index.row());
+    return QVariant();
+}
+
+void ComponentListModel::setCount(int count) {
+    beginResetModel();
+    m_count = count;
+    endResetModel();
+}
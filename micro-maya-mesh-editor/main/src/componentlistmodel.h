@@ -0,0 +1,25 @@
+#ifndef COMPONENTLISTMODEL_H
+#define COMPONENTLISTMODEL_H
+
+#include <QAbstractListModel>
+
+// Lists the ids of one kind of HalfEdgeMesh element (vertices, half-edges or faces).
+// Since an id is the element's index in the mesh, only the count is stored and
+// rows are produced on demand by the view, whatever the size of the mesh.
+class ComponentListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit ComponentListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // Change the number of elements, resetting any view of the model
+    void setCount(int count);
+
+private:
+    int m_count;
+};
+
+#endif // COMPONENTLISTMODEL_H
@@ -0,0 +1,310 @@
+#include "decimation.h"
+#include "objloader.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+// The symmetric 4x4 matrix of a quadric, upper triangle in row order
+struct Quadric {
+    double q[10];
+
+    Quadric() : q() {}
+
+    // The squared distance to the plane ax + by + cz + d = 0, scaled by weight
+    static Quadric plane(const glm::dvec3 &n, double d, double weight) {
+        Quadric r;
+        r.q[0] = weight * n.x * n.x; r.q[1] = weight * n.x * n.y; r.q[2] = weight * n.x * n.z; r.q[3] = weight * n.x * d;
+        r.q[4] = weight * n.y * n.y; r.q[5] = weight * n.y * n.z; r.q[6] = weight * n.y * d;
+        r.q[7] = weight * n.z * n.z; r.q[8] = weight * n.z * d;
+        r.q[9] = weight * d * d;
+        return r;
+    }
+
+    Quadric &operator+=(const Quadric &o) {
+        for (int i = 0; i < 10; i++) q[i] += o.q[i];
+        return *this;
+    }
+
+    double error(const glm::dvec3 &v) const {
+        return q[0] * v.x * v.x + 2 * q[1] * v.x * v.y + 2 * q[2] * v.x * v.z + 2 * q[3] * v.x
+             + q[4] * v.y * v.y + 2 * q[5] * v.y * v.z + 2 * q[6] * v.y
+             + q[7] * v.z * v.z + 2 * q[8] * v.z
+             + q[9];
+    }
+
+    // The point of least error, false if the quadric is too close to singular to have one
+    bool optimum(glm::dvec3 &v) const {
+        glm::dmat3 A(q[0], q[1], q[2],
+                     q[1], q[4], q[5],
+                     q[2], q[5], q[7]);
+        double det = glm::determinant(A);
+        if (std::abs(det) < 1e-12) return false;
+        v = glm::inverse(A) * -glm::dvec3(q[3], q[6], q[8]);
+        return true;
+    }
+};
+
+struct Collapse {
+    double cost;
+    uint32_t a, b;
+    uint32_t versionA, versionB;
+    glm::vec3 pos;
+
+    // Cheapest on top of a std::priority_queue
+    bool operator<(const Collapse &o) const { return cost > o.cost; }
+};
+
+class Decimator {
+public:
+    std::vector<glm::vec3> pos;
+    std::vector<Quadric> quadrics;
+    std::vector<uint32_t> version;
+    std::vector<char> vertDead;
+    std::vector<char> boundary;
+    std::vector<std::vector<uint32_t>> vertTris;
+
+    std::vector<glm::uvec3> tris;
+    std::vector<glm::vec3> triColor;
+    std::vector<char> triDead;
+    uint32_t liveTris = 0;
+
+    std::priority_queue<Collapse> queue;
+
+    void load(const HalfEdgeMesh &mesh);
+    void run(uint32_t target);
+    void write(HalfEdgeMesh &out) const;
+
+private:
+    glm::vec3 normal(const glm::uvec3 &t, uint32_t moved, const glm::vec3 &movedPos) const;
+    void liveNeighbors(uint32_t v, std::vector<uint32_t> &out);
+    void push(uint32_t a, uint32_t b);
+    bool canCollapse(const Collapse &c);
+    void collapse(const Collapse &c);
+
+    std::vector<uint32_t> scratchA, scratchB;
+};
+
+glm::vec3 Decimator::normal(const glm::uvec3 &t, uint32_t moved, const glm::vec3 &movedPos) const {
+    glm::vec3 p[3];
+    for (int i = 0; i < 3; i++) p[i] = t[i] == moved ? movedPos : pos[t[i]];
+    return glm::cross(p[1] - p[0], p[2] - p[0]);
+}
+
+void Decimator::load(const HalfEdgeMesh &mesh) {
+    const uint32_t numVerts = mesh.numVerts();
+    pos.resize(numVerts);
+    for (uint32_t v = 0; v < numVerts; v++) pos[v] = mesh.position(v);
+    quadrics.assign(numVerts, Quadric());
+    version.assign(numVerts, 0);
+    vertDead.assign(numVerts, 0);
+    boundary.assign(numVerts, 0);
+    vertTris.assign(numVerts, {});
+
+    for (uint32_t f = 0; f < mesh.numFaces(); f++) {
+        uint32_t first = mesh.faceEdge[f];
+        for (uint32_t edge = mesh.heNext[first]; mesh.heNext[edge] != first; edge = mesh.heNext[edge]) {
+            glm::uvec3 t(mesh.heVert[first], mesh.heVert[edge], mesh.heVert[mesh.heNext[edge]]);
+            if (t.x == t.y || t.y == t.z || t.z == t.x) continue;
+            uint32_t index = tris.size();
+            tris.push_back(t);
+            triColor.push_back(mesh.faceColor[f]);
+            for (int i = 0; i < 3; i++) vertTris[t[i]].push_back(index);
+
+            // Plane quadric weighted by the triangle's area
+            glm::dvec3 n = glm::dvec3(normal(t, NO_INDEX, glm::vec3()));
+            double area2 = glm::length(n);
+            if (area2 <= 0.0) continue;
+            n /= area2;
+            Quadric plane = Quadric::plane(n, -glm::dot(n, glm::dvec3(pos[t.x])), area2 * 0.5);
+            for (int i = 0; i < 3; i++) quadrics[t[i]] += plane;
+        }
+    }
+    triDead.assign(tris.size(), 0);
+    liveTris = tris.size();
+
+    // Boundary edges: a plane through the edge, perpendicular to its face, heavily weighted
+    for (uint32_t h = 0; h < mesh.numHalfEdges(); h++) {
+        if (mesh.heSym[h] != NO_INDEX) continue;
+        uint32_t a = mesh.heVert[mesh.prevHalfEdge(h)];
+        uint32_t b = mesh.heVert[h];
+        boundary[a] = boundary[b] = 1;
+
+        uint32_t face = mesh.heFace[h];
+        uint32_t first = mesh.faceEdge[face];
+        glm::dvec3 faceNormal(0.0);
+        uint32_t edge = first;
+        do {
+            faceNormal += glm::dvec3(glm::cross(pos[mesh.heVert[edge]], pos[mesh.heVert[mesh.heNext[edge]]]));
+            edge = mesh.heNext[edge];
+        } while (edge != first);
+
+        glm::dvec3 e = glm::dvec3(pos[b] - pos[a]);
+        glm::dvec3 n = glm::cross(e, faceNormal);
+        double len = glm::length(n);
+        if (len <= 0.0) continue;
+        n /= len;
+        Quadric plane = Quadric::plane(n, -glm::dot(n, glm::dvec3(pos[a])), 10.0 * glm::dot(e, e));
+        quadrics[a] += plane;
+        quadrics[b] += plane;
+    }
+
+    std::vector<uint32_t> neighbors;
+    for (uint32_t v = 0; v < numVerts; v++) {
+        liveNeighbors(v, neighbors);
+        for (uint32_t n : neighbors) {
+            if (v < n) push(v, n);
+        }
+    }
+}
+
+void Decimator::liveNeighbors(uint32_t v, std::vector<uint32_t> &out) {
+    // Drop the triangles removed since the last visit while gathering
+    std::vector<uint32_t> &list = vertTris[v];
+    list.erase(std::remove_if(list.begin(), list.end(), [&](uint32_t t) { return triDead[t]; }), list.end());
+
+    out.clear();
+    for (uint32_t t : list) {
+        for (int i = 0; i < 3; i++) {
+            if (tris[t][i] != v) out.push_back(tris[t][i]);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+void Decimator::push(uint32_t a, uint32_t b) {
+    Quadric q = quadrics[a];
+    q += quadrics[b];
+
+    glm::dvec3 best;
+    if (!q.optimum(best)) {
+        // Fall back to the best of the endpoints and the midpoint
+        glm::dvec3 candidates[3] = {glm::dvec3(pos[a]), glm::dvec3(pos[b]), glm::dvec3(pos[a] + pos[b]) * 0.5};
+        best = candidates[0];
+        for (int i = 1; i < 3; i++) {
+            if (q.error(candidates[i]) < q.error(best)) best = candidates[i];
+        }
+    }
+    queue.push({std::max(0.0, q.error(best)), a, b, version[a], version[b], glm::vec3(best)});
+}
+
+bool Decimator::canCollapse(const Collapse &c) {
+    // An interior edge between two boundary vertices would pinch the surface
+    liveNeighbors(c.a, scratchA);
+    liveNeighbors(c.b, scratchB);
+
+    uint32_t shared = 0;
+    uint32_t common = 0;
+    for (uint32_t t : vertTris[c.a]) {
+        const glm::uvec3 &tri = tris[t];
+        if (tri.x == c.b || tri.y == c.b || tri.z == c.b) shared++;
+    }
+    if (shared == 0) return false;
+    if (boundary[c.a] && boundary[c.b] && shared != 1) return false;
+
+    // Link condition: the only vertices adjacent to both ends are the apexes of the shared triangles
+    for (size_t i = 0, j = 0; i < scratchA.size() && j < scratchB.size();) {
+        if (scratchA[i] < scratchB[j]) i++;
+        else if (scratchB[j] < scratchA[i]) j++;
+        else { common++; i++; j++; }
+    }
+    if (common != shared) return false;
+
+    // Refuse to flip or degenerate any remaining triangle
+    for (uint32_t v : {c.a, c.b}) {
+        for (uint32_t t : vertTris[v]) {
+            const glm::uvec3 &tri = tris[t];
+            bool hasA = tri.x == c.a || tri.y == c.a || tri.z == c.a;
+            bool hasB = tri.x == c.b || tri.y == c.b || tri.z == c.b;
+            if (hasA && hasB) continue;
+            glm::vec3 before = normal(tri, NO_INDEX, glm::vec3());
+            glm::vec3 after = normal(tri, v, c.pos);
+            if (glm::dot(before, after) <= 0.f || glm::dot(after, after) <= 1e-12f * glm::dot(before, before)) return false;
+        }
+    }
+    return true;
+}
+
+void Decimator::collapse(const Collapse &c) {
+    // b merges into a, which moves to the optimal position
+    for (uint32_t t : vertTris[c.b]) {
+        glm::uvec3 &tri = tris[t];
+        if (tri.x == c.a || tri.y == c.a || tri.z == c.a) {
+            triDead[t] = 1;
+            liveTris--;
+            continue;
+        }
+        for (int i = 0; i < 3; i++) {
+            if (tri[i] == c.b) tri[i] = c.a;
+        }
+        vertTris[c.a].push_back(t);
+    }
+    vertTris[c.b].clear();
+    vertDead[c.b] = 1;
+
+    pos[c.a] = c.pos;
+    quadrics[c.a] += quadrics[c.b];
+    boundary[c.a] = boundary[c.a] || boundary[c.b];
+    version[c.a]++;
+
+    liveNeighbors(c.a, scratchA);
+    for (uint32_t n : scratchA) push(c.a, n);
+}
+
+void Decimator::run(uint32_t target) {
+    while (liveTris > target && !queue.empty()) {
+        Collapse c = queue.top();
+        queue.pop();
+        if (vertDead[c.a] || vertDead[c.b] || version[c.a] != c.versionA || version[c.b] != c.versionB) continue;
+        if (!canCollapse(c)) continue;
+        collapse(c);
+    }
+}
+
+void Decimator::write(HalfEdgeMesh &out) const {
+    out.clear();
+
+    std::vector<uint32_t> remap(pos.size(), NO_INDEX);
+    uint32_t numVerts = 0;
+    for (uint32_t t = 0; t < tris.size(); t++) {
+        if (triDead[t]) continue;
+        for (int i = 0; i < 3; i++) {
+            if (remap[tris[t][i]] == NO_INDEX) remap[tris[t][i]] = numVerts++;
+        }
+    }
+    out.reserve(numVerts, 3 * liveTris, liveTris);
+    out.posX.resize(numVerts);
+    out.posY.resize(numVerts);
+    out.posZ.resize(numVerts);
+    out.vertEdge.assign(numVerts, NO_INDEX);
+    out.vertSkin.assign(numVerts, SkinInfluences());
+    for (uint32_t v = 0; v < pos.size(); v++) {
+        if (remap[v] != NO_INDEX) out.setPosition(remap[v], pos[v]);
+    }
+
+    for (uint32_t t = 0; t < tris.size(); t++) {
+        if (triDead[t]) continue;
+        uint32_t face = out.addFace(triColor[t]);
+        uint32_t first = out.numHalfEdges();
+        for (uint32_t i = 0; i < 3; i++) {
+            uint32_t vert = remap[tris[t][i]];
+            out.heNext.push_back(first + (i + 1) % 3);
+            out.heFace.push_back(face);
+            out.heVert.push_back(vert);
+            out.vertEdge[vert] = first + i;
+        }
+        out.faceEdge[face] = first;
+    }
+    ObjLoader::pairSyms(out);
+}
+
+} // namespace
+
+void Decimation::decimate(const HalfEdgeMesh &mesh, uint32_t targetTriangles, HalfEdgeMesh &out) {
+    Decimator decimator;
+    decimator.load(mesh);
+    decimator.run(targetTriangles);
+    decimator.write(out);
+}
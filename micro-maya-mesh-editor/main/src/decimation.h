@@ -0,0 +1,19 @@
+#ifndef DECIMATION_H
+#define DECIMATION_H
+
+#include "halfedgemesh.h"
+
+// Garland-Heckbert quadric error edge-collapse decimation, used to produce lighter proxies of a mesh.
+// Faces are fan-triangulated first. Each vertex accumulates the quadric of the planes of its triangles,
+// and edges are collapsed cheapest first from a priority queue into the point that minimizes the
+// summed quadrics. A collapse is refused when it would break the link condition, and with it
+// manifoldness, or flip a triangle. Boundary edges carry an extra quadric that keeps the outline in place.
+class Decimation
+{
+public:
+    // Write to out a triangle mesh of about targetTriangles triangles approximating mesh.
+    // Triangles keep the color of the face they come from. Skin influences are not carried over.
+    static void decimate(const HalfEdgeMesh &mesh, uint32_t targetTriangles, HalfEdgeMesh &out);
+};
+
+#endif // DECIMATION_H
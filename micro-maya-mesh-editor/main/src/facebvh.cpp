@@ -0,0 +1,287 @@
+#include "facebvh.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+const int NUM_BINS = 12;
+const uint32_t MAX_LEAF_SIZE = 4;
+
+float surfaceArea(const glm::vec3 &min, const glm::vec3 &max) {
+    glm::vec3 e = max - min;
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+// Distance to the entry of the ray into the box, or infinity if it misses it before tMax
+float intersectBox(const glm::vec3 &min, const glm::vec3 &max,
+                   const glm::vec3 &origin, const glm::vec3 &invDirection, float tMax) {
+    glm::vec3 t0 = (min - origin) * invDirection;
+    glm::vec3 t1 = (max - origin) * invDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+}
+
+float distanceToSegment(const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b) {
+    glm::vec3 ab = b - a;
+    float len2 = glm::dot(ab, ab);
+    float s = len2 > 0.f ? glm::clamp(glm::dot(p - a, ab) / len2, 0.f, 1.f) : 0.f;
+    return glm::length(p - (a + s * ab));
+}
+
+} // namespace
+
+FaceBvh::FaceBvh()
+{}
+
+void FaceBvh::computeFaceBounds(const HalfEdgeMesh &mesh) {
+    const uint32_t numFaces = mesh.numFaces();
+    faceBoundsMin.resize(numFaces);
+    faceBoundsMax.resize(numFaces);
+    for (uint32_t f = 0; f < numFaces; f++) {
+        uint32_t edge = mesh.faceEdge[f];
+        glm::vec3 lo = mesh.position(mesh.heVert[edge]);
+        glm::vec3 hi = lo;
+        do {
+            glm::vec3 p = mesh.position(mesh.heVert[edge]);
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+            edge = mesh.heNext[edge];
+        } while (edge != mesh.faceEdge[f]);
+        faceBoundsMin[f] = lo;
+        faceBoundsMax[f] = hi;
+    }
+}
+
+void FaceBvh::updateNodeBounds(Node &node) const {
+    node.min = glm::vec3(std::numeric_limits<float>::max());
+    node.max = glm::vec3(-std::numeric_limits<float>::max());
+    for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        node.min = glm::min(node.min, faceBoundsMin[faces[i]]);
+        node.max = glm::max(node.max, faceBoundsMax[faces[i]]);
+    }
+}
+
+void FaceBvh::build(const HalfEdgeMesh &mesh) {
+    computeFaceBounds(mesh);
+    const uint32_t numFaces = mesh.numFaces();
+
+    std::vector<glm::vec3> centroids(numFaces);
+    faces.resize(numFaces);
+    for (uint32_t f = 0; f < numFaces; f++) {
+        centroids[f] = (faceBoundsMin[f] + faceBoundsMax[f]) * 0.5f;
+        faces[f] = f;
+    }
+
+    nodes.clear();
+    if (numFaces == 0) return;
+    // A binary tree with at most one Face per leaf has at most 2n - 1 nodes
+    nodes.reserve(2 * numFaces - 1);
+    nodes.push_back({glm::vec3(), 0, glm::vec3(), numFaces});
+    updateNodeBounds(nodes[0]);
+    subdivide(0, centroids);
+}
+
+void FaceBvh::subdivide(uint32_t rootIndex, const std::vector<glm::vec3> &centroids) {
+    std::vector<uint32_t> stack = {rootIndex};
+    while (!stack.empty()) {
+        uint32_t nodeIndex = stack.back();
+        stack.pop_back();
+        Node node = nodes[nodeIndex];
+        if (node.count <= MAX_LEAF_SIZE) continue;
+
+        // Bin the centroids along each axis and keep the cheapest split plane
+        glm::vec3 cMin(std::numeric_limits<float>::max());
+        glm::vec3 cMax(-std::numeric_limits<float>::max());
+        for (uint32_t i = node.first; i < node.first + node.count; i++) {
+            cMin = glm::min(cMin, centroids[faces[i]]);
+            cMax = glm::max(cMax, centroids[faces[i]]);
+        }
+
+        float bestCost = std::numeric_limits<float>::max();
+        int bestAxis = -1;
+        int bestSplit = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            float extent = cMax[axis] - cMin[axis];
+            if (extent <= 0.f) continue;
+            float scale = NUM_BINS / extent;
+
+            glm::vec3 binMin[NUM_BINS], binMax[NUM_BINS];
+            uint32_t binCount[NUM_BINS] = {};
+            for (int b = 0; b < NUM_BINS; b++) {
+                binMin[b] = glm::vec3(std::numeric_limits<float>::max());
+                binMax[b] = glm::vec3(-std::numeric_limits<float>::max());
+            }
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                uint32_t f = faces[i];
+                int b = std::min(NUM_BINS - 1, (int)((centroids[f][axis] - cMin[axis]) * scale));
+                binCount[b]++;
+                binMin[b] = glm::min(binMin[b], faceBoundsMin[f]);
+                binMax[b] = glm::max(binMax[b], faceBoundsMax[f]);
+            }
+
+            // Sweep from both sides to get the area and count left and right of each plane
+            float leftArea[NUM_BINS - 1];
+            uint32_t leftCount[NUM_BINS - 1];
+            glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+            uint32_t count = 0;
+            for (int b = 0; b < NUM_BINS - 1; b++) {
+                count += binCount[b];
+                if (binCount[b] > 0) {
+                    lo = glm::min(lo, binMin[b]);
+                    hi = glm::max(hi, binMax[b]);
+                }
+                leftCount[b] = count;
+                leftArea[b] = count > 0 ? surfaceArea(lo, hi) : 0.f;
+            }
+            lo = glm::vec3(std::numeric_limits<float>::max());
+            hi = glm::vec3(-std::numeric_limits<float>::max());
+            count = 0;
+            for (int b = NUM_BINS - 1; b > 0; b--) {
+                count += binCount[b];
+                if (binCount[b] > 0) {
+                    lo = glm::min(lo, binMin[b]);
+                    hi = glm::max(hi, binMax[b]);
+                }
+                float rightArea = count > 0 ? surfaceArea(lo, hi) : 0.f;
+                float cost = leftCount[b - 1] * leftArea[b - 1] + count * rightArea;
+                if (leftCount[b - 1] > 0 && count > 0 && cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        // Stay a leaf when splitting costs more than intersecting every Face
+        float leafCost = node.count * surfaceArea(node.min, node.max);
+        if (bestAxis < 0 || bestCost >= leafCost) continue;
+
+        float scale = NUM_BINS / (cMax[bestAxis] - cMin[bestAxis]);
+        auto middle = std::partition(faces.begin() + node.first, faces.begin() + node.first + node.count,
+                                     [&](uint32_t f) {
+            int b = std::min(NUM_BINS - 1, (int)((centroids[f][bestAxis] - cMin[bestAxis]) * scale));
+            return b < bestSplit;
+        });
+        uint32_t leftCount = middle - (faces.begin() + node.first);
+
+        uint32_t left = nodes.size();
+        nodes.push_back({glm::vec3(), node.first, glm::vec3(), leftCount});
+        nodes.push_back({glm::vec3(), node.first + leftCount, glm::vec3(), node.count - leftCount});
+        updateNodeBounds(nodes[left]);
+        updateNodeBounds(nodes[left + 1]);
+        nodes[nodeIndex].first = left;
+        nodes[nodeIndex].count = 0;
+
+        stack.push_back(left);
+        stack.push_back(left + 1);
+    }
+}
+
+void FaceBvh::refit(const HalfEdgeMesh &mesh) {
+    computeFaceBounds(mesh);
+    // Children are always stored after their parent
+    for (uint32_t i = nodes.size(); i-- > 0;) {
+        Node &node = nodes[i];
+        if (node.count > 0) {
+            updateNodeBounds(node);
+        } else {
+            node.min = glm::min(nodes[node.first].min, nodes[node.first + 1].min);
+            node.max = glm::max(nodes[node.first].max, nodes[node.first + 1].max);
+        }
+    }
+}
+
+float FaceBvh::intersectFace(const HalfEdgeMesh &mesh, uint32_t face, const glm::vec3 &origin, const glm::vec3 &direction) {
+    // Möller-Trumbore on each triangle of the fan around the first vertex, from both sides
+    uint32_t first = mesh.faceEdge[face];
+    glm::vec3 p0 = mesh.position(mesh.heVert[first]);
+    float closest = -1.f;
+    for (uint32_t edge = mesh.heNext[first]; mesh.heNext[edge] != first; edge = mesh.heNext[edge]) {
+        glm::vec3 p1 = mesh.position(mesh.heVert[edge]);
+        glm::vec3 p2 = mesh.position(mesh.heVert[mesh.heNext[edge]]);
+        glm::vec3 e1 = p1 - p0;
+        glm::vec3 e2 = p2 - p0;
+        glm::vec3 pv = glm::cross(direction, e2);
+        float det = glm::dot(e1, pv);
+        if (std::abs(det) < 1e-12f) continue;
+        float invDet = 1.f / det;
+        glm::vec3 tv = origin - p0;
+        float u = glm::dot(tv, pv) * invDet;
+        if (u < 0.f || u > 1.f) continue;
+        glm::vec3 qv = glm::cross(tv, e1);
+        float v = glm::dot(direction, qv) * invDet;
+        if (v < 0.f || u + v > 1.f) continue;
+        float t = glm::dot(e2, qv) * invDet;
+        if (t > 0.f && (closest < 0.f || t < closest)) closest = t;
+    }
+    return closest;
+}
+
+bool FaceBvh::pick(const HalfEdgeMesh &mesh, const glm::vec3 &origin, const glm::vec3 &direction, Pick &out) const {
+    if (nodes.empty()) return false;
+
+    const glm::vec3 invDirection = 1.f / direction;
+    float tBest = std::numeric_limits<float>::infinity();
+    uint32_t faceBest = NO_INDEX;
+
+    // Visit the nearer child first so the farther one can be culled by the closest hit so far
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    if (intersectBox(nodes[0].min, nodes[0].max, origin, invDirection, tBest) < tBest) stack.push_back(0);
+    while (!stack.empty()) {
+        const Node &node = nodes[stack.back()];
+        stack.pop_back();
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                float t = intersectFace(mesh, faces[i], origin, direction);
+                if (t > 0.f && t < tBest) {
+                    tBest = t;
+                    faceBest = faces[i];
+                }
+            }
+            continue;
+        }
+
+        uint32_t near = node.first;
+        uint32_t far = node.first + 1;
+        float tNear = intersectBox(nodes[near].min, nodes[near].max, origin, invDirection, tBest);
+        float tFar = intersectBox(nodes[far].min, nodes[far].max, origin, invDirection, tBest);
+        if (tFar < tNear) {
+            std::swap(near, far);
+            std::swap(tNear, tFar);
+        }
+        if (tFar < tBest) stack.push_back(far);
+        if (tNear < tBest) stack.push_back(near);
+    }
+    if (faceBest == NO_INDEX) return false;
+
+    out.face = faceBest;
+    out.t = tBest;
+    out.point = origin + tBest * direction;
+
+    // The HalfEdge whose segment and the Vertex closest to the hit point on that Face
+    float edgeDistance = std::numeric_limits<float>::max();
+    float vertDistance = std::numeric_limits<float>::max();
+    uint32_t edge = mesh.faceEdge[faceBest];
+    uint32_t prevVert = mesh.heVert[mesh.prevHalfEdge(edge)];
+    do {
+        uint32_t vert = mesh.heVert[edge];
+        glm::vec3 p = mesh.position(vert);
+        float d = distanceToSegment(out.point, mesh.position(prevVert), p);
+        if (d < edgeDistance) {
+            edgeDistance = d;
+            out.halfEdge = edge;
+        }
+        d = glm::length(out.point - p);
+        if (d < vertDistance) {
+            vertDistance = d;
+            out.vert = vert;
+        }
+        prevVert = vert;
+        edge = mesh.heNext[edge];
+    } while (edge != mesh.faceEdge[faceBest]);
+    return true;
+}
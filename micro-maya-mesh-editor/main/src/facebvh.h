@@ -0,0 +1,56 @@
+#ifndef FACEBVH_H
+#define FACEBVH_H
+
+#include "halfedgemesh.h"
+
+// A bounding volume hierarchy over the Faces of a HalfEdgeMesh, used to pick geometry under the mouse.
+// Built top-down with the surface area heuristic evaluated over a fixed number of bins per axis.
+// When vertices move without the topology changing, refit() updates the boxes in place.
+class FaceBvh
+{
+public:
+    // The result of a pick: the Face hit first, and on it the HalfEdge and Vertex closest to the hit point
+    struct Pick {
+        uint32_t face;
+        uint32_t halfEdge;
+        uint32_t vert;
+        float t; // Distance along the ray, in units of its direction
+        glm::vec3 point;
+    };
+
+    FaceBvh();
+
+    // Build the hierarchy over every Face of mesh, replacing any previous content
+    void build(const HalfEdgeMesh &mesh);
+    // Recompute every box bottom-up after vertices moved. The topology must be the one given to build().
+    void refit(const HalfEdgeMesh &mesh);
+
+    // The number of Faces the hierarchy was built over
+    uint32_t numFaces() const { return faceBoundsMin.size(); }
+
+    // Cast the ray origin + t * direction, t > 0, against mesh. Returns false if nothing is hit.
+    bool pick(const HalfEdgeMesh &mesh, const glm::vec3 &origin, const glm::vec3 &direction, Pick &out) const;
+
+private:
+    struct Node {
+        glm::vec3 min;
+        uint32_t first; // Leaf: index of the first Face in faces. Interior: index of the left child, right is first + 1.
+        glm::vec3 max;
+        uint32_t count; // Number of Faces of a leaf, 0 for an interior node
+    };
+
+    std::vector<Node> nodes;
+    // Face indices, each leaf owning a contiguous range
+    std::vector<uint32_t> faces;
+    std::vector<glm::vec3> faceBoundsMin;
+    std::vector<glm::vec3> faceBoundsMax;
+
+    void computeFaceBounds(const HalfEdgeMesh &mesh);
+    void updateNodeBounds(Node &node) const;
+    void subdivide(uint32_t nodeIndex, const std::vector<glm::vec3> &centroids);
+
+    // Closest hit of the ray with a Face, fan-triangulated, or a negative value if missed
+    static float intersectFace(const HalfEdgeMesh &mesh, uint32_t face, const glm::vec3 &origin, const glm::vec3 &direction);
+};
+
+#endif // FACEBVH_H
@@ -1,26 +1,25 @@
 #include "facedisplay.h"
-#include "halfedge.h"
 
 FaceDisplay::FaceDisplay(OpenGLContext* context)
-    : Drawable(context), representedFace(nullptr)
+    : Drawable(context), mesh(nullptr), representedFace(NO_INDEX)
 {}
 
 void FaceDisplay::create() {
-    if (representedFace) {
+    if (mesh && representedFace != NO_INDEX) {
         std::vector<glm::vec4> positions;
         std::vector<glm::vec4> colors;
         std::vector<GLuint> indices;
 
-        HalfEdge* edge = representedFace->edge;
+        uint32_t edge = mesh->faceEdge[representedFace];
         int edgeCount = 0;
 
         // Colored with the opposite color of the Face.
         do {
-            positions.push_back(glm::vec4(edge->vert->pos, 1));
-            colors.push_back(glm::vec4(1.f - representedFace->color, 1));
-            edge = edge->next;
+            positions.push_back(glm::vec4(mesh->position(mesh->heVert[edge]), 1));
+            colors.push_back(glm::vec4(1.f - mesh->faceColor[representedFace], 1));
+            edge = mesh->heNext[edge];
             edgeCount ++;
-        } while (edge != representedFace->edge);
+        } while (edge != mesh->faceEdge[representedFace]);
 
         // An edge line has two vertex
         for (int i = 0; i < edgeCount; i ++) {
@@ -48,7 +47,8 @@ GLenum FaceDisplay::drawMode() {
     return GL_LINES;
 }
 
-void FaceDisplay::updateFace(Face* face) {
+void FaceDisplay::updateFace(const HalfEdgeMesh* mesh, uint32_t face) {
+    this->mesh = mesh;
     representedFace = face;
 }
 
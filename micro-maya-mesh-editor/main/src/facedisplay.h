@@ -1,12 +1,13 @@
 #ifndef FACEDISPLAY_H
 #define FACEDISPLAY_H
 
-#include "face.h"
+#include "halfedgemesh.h"
 #include <drawable.h>
 
 class FaceDisplay : public Drawable {
 protected:
-    Face *representedFace;
+    const HalfEdgeMesh *mesh;
+    uint32_t representedFace;
 
 public:
     FaceDisplay(OpenGLContext* context);
@@ -17,8 +18,8 @@ public:
     // A selected Face should be surrounded by a strip of GL_LINES
     GLenum drawMode() override;
 
-    // Change which Face representedFace points to
-    void updateFace(Face*);
+    // Change which Face of the mesh is represented, NO_INDEX for none
+    void updateFace(const HalfEdgeMesh*, uint32_t);
 };
 
 #endif // FACEDISPLAY_H
@@ -2,20 +2,20 @@
 #include <QDebug>
 
 HalfEdgeDisplay::HalfEdgeDisplay(OpenGLContext* context)
-    : Drawable(context), representedHalfEdge(nullptr)
+    : Drawable(context), mesh(nullptr), representedHalfEdge(NO_INDEX)
 {}
 
 void HalfEdgeDisplay::create() {
-    if (representedHalfEdge) {
+    if (mesh && representedHalfEdge != NO_INDEX) {
         std::vector<glm::vec4> positions;
         std::vector<glm::vec4> colors;
         std::vector<GLuint> indices;
 
-        positions.push_back(glm::vec4(representedHalfEdge->vert->pos, 1));
+        positions.push_back(glm::vec4(mesh->position(mesh->heVert[representedHalfEdge]), 1));
         colors.push_back(glm::vec4(1, 1, 0, 1)); // Yellow
         indices.push_back(0);
 
-        positions.push_back(glm::vec4(representedHalfEdge->sym->vert->pos, 1));
+        positions.push_back(glm::vec4(mesh->position(mesh->heVert[mesh->prevHalfEdge(representedHalfEdge)]), 1));
         colors.push_back(glm::vec4(1, 0, 0, 1)); // Red
         indices.push_back(1);
 
@@ -39,7 +39,8 @@ GLenum HalfEdgeDisplay::drawMode() {
     return GL_LINES;
 }
 
-void HalfEdgeDisplay::updateHalfEdge(HalfEdge* halfEdge) {
+void HalfEdgeDisplay::updateHalfEdge(const HalfEdgeMesh* mesh, uint32_t halfEdge) {
+    this->mesh = mesh;
     representedHalfEdge = halfEdge;
 }
 
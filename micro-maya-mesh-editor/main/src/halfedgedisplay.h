@@ -1,12 +1,13 @@
 #ifndef HalfEdgeDISPLAY_H
 #define HalfEdgeDISPLAY_H
 
-#include "halfedge.h"
+#include "halfedgemesh.h"
 #include <drawable.h>
 
 class HalfEdgeDisplay : public Drawable {
 protected:
-    HalfEdge *representedHalfEdge;
+    const HalfEdgeMesh *mesh;
+    uint32_t representedHalfEdge;
 
 public:
     HalfEdgeDisplay(OpenGLContext* context);
@@ -17,8 +18,8 @@ public:
     // A selected HalfEdge should be represented as a single GL_LINES
     GLenum drawMode() override;
 
-    // Change which HalfEdge representedHalfEdge points to
-    void updateHalfEdge(HalfEdge*);
+    // Change which HalfEdge of the mesh is represented, NO_INDEX for none
+    void updateHalfEdge(const HalfEdgeMesh*, uint32_t);
 };
 
 #endif // HalfEdgeDISPLAY_H
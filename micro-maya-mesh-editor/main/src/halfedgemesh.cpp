@@ -0,0 +1,244 @@
+#include "halfedgemesh.h"
+#include "kdtree.h"
+#include "parallel.h"
+#include "subdivision.h"
+#include "triangulation.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+void SkinInfluences::set(const std::pair<int, float> *influences, int count) {
+    count = std::min(count, MAX);
+    float sum = 0.f;
+    for (int i = 0; i < count; i++) sum += influences[i].second;
+
+    int total = 0;
+    for (int i = 0; i < MAX; i++) {
+        bool used = i < count && sum > 0.f;
+        joint[i] = used ? influences[i].first : 0;
+        weight[i] = used ? (uint16_t)std::lround(influences[i].second / sum * 65535.f) : 0;
+        total += weight[i];
+    }
+    // Give the rounding error to the strongest influence so the weights sum to one exactly
+    if (total > 0) weight[0] += 65535 - total;
+}
+
+void SkinBlend::add(const SkinInfluences &skin) {
+    for (int i = 0; i < SkinInfluences::MAX && skin.weight[i] > 0; i++) {
+        int joint = skin.joint[i];
+        float weight = skin.weightf(i);
+        int slot = 0;
+        while (slot < count && influences[slot].first != joint) slot++;
+        if (slot < count) {
+            influences[slot].second += weight;
+        } else if (count < CAPACITY) {
+            influences[count++] = {joint, weight};
+        } else {
+            auto weakest = std::min_element(influences, influences + count, [](const std::pair<int, float> &a,
+                                                                             const std::pair<int, float> &b) {
+                return a.second < b.second;
+            });
+            if (weakest->second < weight) *weakest = {joint, weight};
+        }
+    }
+}
+
+SkinInfluences SkinBlend::result() {
+    std::sort(influences, influences + count, [](const std::pair<int, float> &a, const std::pair<int, float> &b) {
+        return a.second > b.second;
+    });
+    SkinInfluences skin;
+    skin.set(influences, count);
+    return skin;
+}
+
+glm::vec3 HalfEdgeMesh::getRandomColor() {
+    static std::default_random_engine generator;
+    std::uniform_real_distribution<float> distribution(0.0, 1.0);
+    float g = distribution(generator);
+    return glm::vec3(g);
+}
+
+HalfEdgeMesh::HalfEdgeMesh()
+    : skinningMethod(LINEAR_BLEND)
+{}
+
+void HalfEdgeMesh::setPosition(uint32_t vert, const glm::vec3 &pos) {
+    posX[vert] = pos.x;
+    posY[vert] = pos.y;
+    posZ[vert] = pos.z;
+}
+
+uint32_t HalfEdgeMesh::addVertex(const glm::vec3 &pos) {
+    posX.push_back(pos.x);
+    posY.push_back(pos.y);
+    posZ.push_back(pos.z);
+    vertEdge.push_back(NO_INDEX);
+    vertSkin.emplace_back();
+    return vertEdge.size() - 1;
+}
+
+uint32_t HalfEdgeMesh::addHalfEdge() {
+    heNext.push_back(NO_INDEX);
+    heSym.push_back(NO_INDEX);
+    heFace.push_back(NO_INDEX);
+    heVert.push_back(NO_INDEX);
+    return heNext.size() - 1;
+}
+
+uint32_t HalfEdgeMesh::addFace(const glm::vec3 &color) {
+    faceEdge.push_back(NO_INDEX);
+    faceColor.push_back(color);
+    return faceEdge.size() - 1;
+}
+
+void HalfEdgeMesh::reserve(uint32_t verts, uint32_t halfEdges, uint32_t faces) {
+    heNext.reserve(halfEdges);
+    heSym.reserve(halfEdges);
+    heFace.reserve(halfEdges);
+    heVert.reserve(halfEdges);
+    posX.reserve(verts);
+    posY.reserve(verts);
+    posZ.reserve(verts);
+    vertEdge.reserve(verts);
+    vertSkin.reserve(verts);
+    faceEdge.reserve(faces);
+    faceColor.reserve(faces);
+}
+
+void HalfEdgeMesh::clear() {
+    heNext.clear();
+    heSym.clear();
+    heFace.clear();
+    heVert.clear();
+    posX.clear();
+    posY.clear();
+    posZ.clear();
+    vertEdge.clear();
+    vertSkin.clear();
+    faceEdge.clear();
+    faceColor.clear();
+}
+
+int HalfEdgeMesh::faceDegree(uint32_t face) const {
+    uint32_t edge = faceEdge[face];
+    int degree = 0;
+    do {
+        edge = heNext[edge];
+        degree ++;
+    } while (edge != faceEdge[face]);
+    return degree;
+}
+
+uint32_t HalfEdgeMesh::prevHalfEdge(uint32_t edge) const {
+    uint32_t prev = edge;
+    while (heNext[prev] != edge) {
+        prev = heNext[prev];
+    }
+    return prev;
+}
+
+void HalfEdgeMesh::splitEdge(uint32_t edge) {
+    // Step 1: Create the new vertex V3
+    uint32_t HE1 = edge;
+    uint32_t HE2 = heSym[edge];
+    uint32_t V1 = heVert[HE1];
+    uint32_t V2 = HE2 != NO_INDEX ? heVert[HE2] : heVert[prevHalfEdge(HE1)];
+    uint32_t V3 = addVertex((position(V1) + position(V2)) / 2.f);
+    SkinBlend blend;
+    blend.add(vertSkin[V1]);
+    blend.add(vertSkin[V2]);
+    vertSkin[V3] = blend.result();
+
+    // Step 2: Create the new half-edge HE1B (and HE2B unless on a boundary) needed to surround V3
+    uint32_t HE1B = addHalfEdge();
+    heVert[HE1B] = V1;
+    heFace[HE1B] = heFace[HE1];
+    vertEdge[V1] = HE1B;
+    vertEdge[V3] = HE1;
+
+    // Step 3: Adjust the sym, next, and vert indices of HE1, HE2, HE1B, and HE2B
+    heNext[HE1B] = heNext[HE1];
+    heNext[HE1] = HE1B;
+    heVert[HE1] = V3;
+
+    if (HE2 != NO_INDEX) {
+        uint32_t HE2B = addHalfEdge();
+        heVert[HE2B] = V2;
+        heFace[HE2B] = heFace[HE2];
+        vertEdge[V2] = HE2B;
+
+        heNext[HE2B] = heNext[HE2];
+        heNext[HE2] = HE2B;
+        heVert[HE2] = V3;
+        heSym[HE1B] = HE2;
+        heSym[HE2B] = HE1;
+        heSym[HE1] = HE2B;
+        heSym[HE2] = HE1B;
+    }
+}
+
+void HalfEdgeMesh::triangulate(uint32_t face) {
+    uint32_t HE_0 = faceEdge[face];
+    int numVerts = faceDegree(face);
+
+    uint32_t FACE1 = face;
+    for (int i = 0; i < numVerts - 3; i ++) {
+        // Step 1: Create two new half-edges HE_A and HE_B
+        uint32_t HE_A = addHalfEdge();
+        uint32_t HE_B = addHalfEdge();
+        heVert[HE_A] = heVert[HE_0];
+        heVert[HE_B] = heVert[heNext[heNext[HE_0]]];
+        heSym[HE_A] = HE_B;
+        heSym[HE_B] = HE_A;
+
+        // Step 2: Create a second face FACE2
+        uint32_t FACE2 = addFace(getRandomColor());
+        heFace[HE_A] = FACE2;
+        heFace[heNext[HE_0]] = FACE2;
+        heFace[heNext[heNext[HE_0]]] = FACE2;
+        heFace[HE_B] = FACE1;
+        faceEdge[FACE2] = HE_A;
+
+        // Step 3: Fix up the next indices for our half-edges
+        heNext[HE_B] = heNext[heNext[heNext[HE_0]]];
+        heNext[heNext[heNext[HE_0]]] = HE_A;
+        heNext[HE_A] = heNext[HE_0];
+        heNext[HE_0] = HE_B;
+    }
+}
+
+void HalfEdgeMesh::triangulateAll() {
+    Triangulation::triangulate(*this);
+}
+
+void HalfEdgeMesh::bindNearestJoints(const std::vector<glm::vec3> &jointPos, int influences) {
+    KdTree tree;
+    tree.build(jointPos);
+    influences = std::max(1, std::min({influences, (int)jointPos.size(), SkinInfluences::MAX}));
+
+    parallelFor(0, numVerts(), [&](uint32_t vert) {
+        // Pair of index and squared distance, nearest first
+        std::pair<int, float> nearest[SkinInfluences::MAX];
+        int found = tree.nearest(position(vert), influences, nearest);
+
+        // A vertex sitting on a joint follows only that joint
+        if (found > 0 && nearest[0].second < 1e-12f) {
+            nearest[0].second = 1.f;
+            found = 1;
+        } else {
+            for (int i = 0; i < found; i++) {
+                nearest[i].second = 1.f / nearest[i].second;
+            }
+        }
+        vertSkin[vert].set(nearest, found);
+    }, 1024);
+}
+
+void HalfEdgeMesh::subdivision(int levels) {
+    Subdivision::catmullClark(*this, levels);
+}
+
+void HalfEdgeMesh::subdivision(std::vector<uint32_t> &faces, int levels) {
+    Subdivision::catmullClark(*this, faces, levels);
+}
@@ -0,0 +1,158 @@
+#ifndef HALFEDGEMESH_H
+#define HALFEDGEMESH_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Marks a missing element, e.g. the sym of a half-edge on a boundary
+static const uint32_t NO_INDEX = 0xFFFFFFFFu;
+
+// The joints that influence a Vertex, stored inline so that binding, VBO creation and skinning
+// never allocate. Influences are sorted by decreasing weight, unused slots have weight 0.
+// Weights are unorm16 and sum to exactly 65535 on a bound vertex.
+struct SkinInfluences
+{
+    static constexpr int MAX = 4;
+
+    uint16_t joint[MAX];
+    uint16_t weight[MAX];
+
+    SkinInfluences() : joint(), weight() {}
+
+    bool empty() const { return weight[0] == 0; }
+    float weightf(int i) const { return weight[i] / 65535.f; }
+
+    // Normalize and quantize up to MAX (joint, weight) pairs sorted by decreasing weight
+    void set(const std::pair<int, float> *influences, int count);
+};
+
+// Sums the influences of the vertices a new vertex is inserted between, e.g. by subdivision,
+// so that it follows the skeleton like its neighbors instead of staying in the rest pose
+struct SkinBlend
+{
+    // Distinct joints kept while summing, the weakest is dropped beyond that
+    static constexpr int CAPACITY = 16;
+
+    std::pair<int, float> influences[CAPACITY];
+    int count;
+
+    SkinBlend() : count(0) {}
+
+    void add(const SkinInfluences &skin);
+    // The strongest SkinInfluences::MAX joints, empty if only unbound vertices were added
+    SkinInfluences result();
+};
+
+// How a bound mesh follows its skeleton, see Skinning
+enum SkinningMethod {
+    // Blend each vertex's palette matrices, cheap but collapses volume around twisting joints
+    LINEAR_BLEND,
+    // Blend each vertex's palette dual quaternions, which keeps the blended transformation rigid
+    DUAL_QUATERNION
+};
+
+// The connectivity and geometry of a polygon mesh, free of any Qt or OpenGL type.
+// Every Vertex, HalfEdge and Face is an index into the contiguous arrays below,
+// which is also the id shown in the UI.
+class HalfEdgeMesh
+{
+public:
+    HalfEdgeMesh();
+
+    // The next HalfEdge in the loop of HalfEdges that lie on this HalfEdge's Face
+    std::vector<uint32_t> heNext;
+    // The HalfEdge that travels in the opposite direction on the adjacent Face, NO_INDEX on a boundary
+    std::vector<uint32_t> heSym;
+    // The Face on which this HalfEdge lies
+    std::vector<uint32_t> heFace;
+    // The Vertex this HalfEdge points to
+    std::vector<uint32_t> heVert;
+
+    // Vertex positions, one array per component
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> posZ;
+    // One of the HalfEdges that points to this Vertex
+    std::vector<uint32_t> vertEdge;
+    // Which joints influence this Vertex's transformation and by how much
+    std::vector<SkinInfluences> vertSkin;
+    // How vertSkin is applied, on the CPU by Skinning and on the GPU by the skeleton shaders
+    SkinningMethod skinningMethod;
+
+    // One of the HalfEdges that lies on this Face
+    std::vector<uint32_t> faceEdge;
+    // This Face's color as an RGB value
+    std::vector<glm::vec3> faceColor;
+
+    uint32_t numVerts() const { return vertEdge.size(); }
+    uint32_t numHalfEdges() const { return heNext.size(); }
+    uint32_t numFaces() const { return faceEdge.size(); }
+
+    glm::vec3 position(uint32_t vert) const { return glm::vec3(posX[vert], posY[vert], posZ[vert]); }
+    void setPosition(uint32_t vert, const glm::vec3 &pos);
+
+    // Append an unconnected element and return its index
+    uint32_t addVertex(const glm::vec3 &pos);
+    uint32_t addHalfEdge();
+    uint32_t addFace(const glm::vec3 &color);
+
+    // Grow the capacity of every array to hold at least this many elements, so that building
+    // a mesh of known size appends into contiguous storage without reallocating
+    void reserve(uint32_t verts, uint32_t halfEdges, uint32_t faces);
+
+    // Remove every element. Capacity is kept for the next mesh, and since every element is
+    // trivially destructible this takes constant time whatever the mesh size.
+    void clear();
+
+    // The number of HalfEdges around a Face
+    int faceDegree(uint32_t face) const;
+    // The HalfEdge whose next is edge
+    uint32_t prevHalfEdge(uint32_t edge) const;
+    // Call func(edge) for every HalfEdge pointing to vert, walking around it across syms.
+    // Vertices on a boundary are walked in both directions from vertEdge.
+    template<typename Func>
+    void forEachIncoming(uint32_t vert, const Func &func) const;
+
+    // Split the edge of a HalfEdge and its sym at their midpoint
+    void splitEdge(uint32_t edge);
+    // Fan-triangulate a Face around its first HalfEdge
+    void triangulate(uint32_t face);
+    // Triangulate every Face by ear clipping, see Triangulation
+    void triangulateAll();
+    // Catmull-Clark subdivision, see Subdivision
+    void subdivision(int levels = 1);
+    // Catmull-Clark subdivision of the given Faces only, which become the Faces of the refined region
+    void subdivision(std::vector<uint32_t> &faces, int levels = 1);
+
+    // Bind every vertex to its nearest joints, weighted by inverse squared distance.
+    // jointPos holds the world position of each joint, influences is the number of joints per vertex
+    // and is clamped to SkinInfluences::MAX.
+    void bindNearestJoints(const std::vector<glm::vec3> &jointPos, int influences);
+
+    static glm::vec3 getRandomColor();
+};
+
+template<typename Func>
+void HalfEdgeMesh::forEachIncoming(uint32_t vert, const Func &func) const {
+    uint32_t start = vertEdge[vert];
+    if (start == NO_INDEX) return;
+
+    uint32_t edge = start;
+    do {
+        func(edge);
+        edge = heSym[heNext[edge]];
+    } while (edge != NO_INDEX && edge != start);
+
+    if (edge == NO_INDEX) {
+        edge = heSym[start];
+        while (edge != NO_INDEX) {
+            edge = prevHalfEdge(edge);
+            func(edge);
+            edge = heSym[edge];
+        }
+    }
+}
+
+#endif // HALFEDGEMESH_H
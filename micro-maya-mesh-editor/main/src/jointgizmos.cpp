@@ -0,0 +1,127 @@
+#include "jointgizmos.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+JointGizmos::JointGizmos(OpenGLContext *context)
+    : Drawable(context), instanceBuffer(), instanceTexture(), instancesCreated(false), uploaded(), instances()
+{}
+
+JointGizmos::~JointGizmos() {
+    destroyInstances();
+}
+
+void JointGizmos::create() {
+    const int numSegments = 36;
+    const float radius = 0.5f;
+
+    std::vector<GLuint> indices;
+    std::vector<glm::vec4> vertices;
+    std::vector<glm::vec4> colors;
+
+    // w = 1 marks a circle point, in the joint's frame
+    const glm::vec4 axisColors[3] = {glm::vec4(1, 0, 0, 1), glm::vec4(0, 1, 0, 1), glm::vec4(0, 0, 1, 1)};
+    for (int axis = 0; axis < 3; axis++) {
+        GLuint first = vertices.size();
+        for (int i = 0; i < numSegments; i++) {
+            float angle = 2.f * M_PI * i / numSegments;
+            glm::vec4 point(0.f, 0.f, 0.f, 1.f);
+            point[axis == 2 ? 1 : 0] = radius * std::cos(angle);
+            point[axis == 0 ? 1 : 2] = radius * std::sin(angle);
+            vertices.push_back(point);
+            colors.push_back(axisColors[axis]);
+            indices.push_back(first + i);
+            indices.push_back(first + (i + 1) % numSegments);
+        }
+    }
+
+    // w = 0 marks an end of the link, x = 0 at the joint and x = 1 at its parent
+    indices.push_back(vertices.size());
+    vertices.push_back(glm::vec4(0, 0, 0, 0));
+    colors.push_back(glm::vec4(1, 1, 0, 1)); // yellow
+    indices.push_back(vertices.size());
+    vertices.push_back(glm::vec4(1, 0, 0, 0));
+    colors.push_back(glm::vec4(1, 0, 1, 1)); // magenta
+
+    generateIdx();
+    bindIdx();
+    mp_context->glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+    generatePos();
+    bindPos();
+    mp_context->glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec4), vertices.data(), GL_STATIC_DRAW);
+
+    generateCol();
+    bindCol();
+    mp_context->glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(glm::vec4), colors.data(), GL_STATIC_DRAW);
+
+    count = indices.size();
+
+    if (!instancesCreated) {
+        mp_context->glGenBuffers(1, &instanceBuffer);
+        mp_context->glGenTextures(1, &instanceTexture);
+        instancesCreated = true;
+    }
+}
+
+void JointGizmos::destroyInstances() {
+    if (!instancesCreated) return;
+    mp_context->glDeleteBuffers(1, &instanceBuffer);
+    mp_context->glDeleteTextures(1, &instanceTexture);
+    uploaded.clear();
+    instancesCreated = false;
+}
+
+GLenum JointGizmos::drawMode() {
+    return GL_LINES;
+}
+
+void JointGizmos::update(const std::vector<glm::mat4> &world, const std::vector<int> &parent, int chosenJoint) {
+    if (!instancesCreated) return;
+
+    const size_t numJoints = world.size();
+    instances.resize(numJoints);
+    for (size_t j = 0; j < numJoints; j++) {
+        instances[j].world = world[j];
+        instances[j].parentPos = parent[j] >= 0 ? world[parent[j]][3] : world[j][3];
+        instances[j].tint = (int)j == chosenJoint ? glm::vec4(1.f) : glm::vec4(0.f);
+    }
+    if (numJoints == 0) {
+        uploaded.clear();
+        return;
+    }
+
+    mp_context->glBindBuffer(GL_TEXTURE_BUFFER, instanceBuffer);
+
+    if (numJoints != uploaded.size()) {
+        mp_context->glBufferData(GL_TEXTURE_BUFFER, numJoints * sizeof(Instance), instances.data(), GL_DYNAMIC_DRAW);
+        // The texture has to be attached again after the buffer's storage changed
+        mp_context->glBindTexture(GL_TEXTURE_BUFFER, instanceTexture);
+        mp_context->glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instanceBuffer);
+        uploaded = instances;
+        return;
+    }
+
+    for (size_t begin = 0; begin < numJoints;) {
+        if (std::memcmp(&instances[begin], &uploaded[begin], sizeof(Instance)) == 0) {
+            begin++;
+            continue;
+        }
+        size_t end = begin + 1;
+        while (end < numJoints && std::memcmp(&instances[end], &uploaded[end], sizeof(Instance)) != 0) end++;
+
+        mp_context->glBufferSubData(GL_TEXTURE_BUFFER, begin * sizeof(Instance),
+                                    (end - begin) * sizeof(Instance), &instances[begin]);
+        std::copy(instances.begin() + begin, instances.begin() + end, uploaded.begin() + begin);
+        begin = end;
+    }
+}
+
+void JointGizmos::bindInstances(int unit) {
+    mp_context->glActiveTexture(GL_TEXTURE0 + unit);
+    mp_context->glBindTexture(GL_TEXTURE_BUFFER, instanceTexture);
+}
+
+int JointGizmos::instanceCount() const {
+    return uploaded.size();
+}
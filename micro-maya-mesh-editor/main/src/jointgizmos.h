@@ -0,0 +1,50 @@
+#ifndef JOINTGIZMOS_H
+#define JOINTGIZMOS_H
+
+#include "drawable.h"
+#include <vector>
+
+// The joints of a Skeleton drawn with glDrawElementsInstanced, one instance per joint.
+// The gizmo mesh, three circles around the axes and a link to the parent joint, is uploaded once.
+// Each joint's world matrix, parent position and tint live in a texture buffer that gizmo.vert.glsl
+// reads by gl_InstanceID, and only the records that changed since the last update are uploaded.
+class JointGizmos : public Drawable
+{
+public:
+    JointGizmos(OpenGLContext *context);
+    ~JointGizmos();
+
+    // Upload the gizmo mesh and allocate the instance buffer and its texture
+    void create() override;
+    // Free the instance buffer and its texture, destroy() frees the mesh
+    void destroyInstances();
+
+    GLenum drawMode() override;
+
+    // Rebuild the records from every joint's world matrix and parent. The chosen joint, -1 for none,
+    // is drawn white. Selecting a joint changes two records, moving one changes those of its subtree.
+    void update(const std::vector<glm::mat4> &world, const std::vector<int> &parent, int chosenJoint);
+
+    // Bind the instance texture to GL_TEXTURE_BUFFER on the given texture unit
+    void bindInstances(int unit);
+
+    int instanceCount() const;
+
+private:
+    // One record is six RGBA32F texels, keep in sync with gizmo.vert.glsl
+    struct Instance {
+        glm::mat4 world;
+        glm::vec4 parentPos; // The position of the parent joint, the joint's own for a root
+        glm::vec4 tint;      // Replaces the circles' axis colors when alpha is 1
+    };
+
+    GLuint instanceBuffer;
+    GLuint instanceTexture;
+    bool instancesCreated;
+
+    // What the GPU currently holds, and the records being built
+    std::vector<Instance> uploaded;
+    std::vector<Instance> instances;
+};
+
+#endif // JOINTGIZMOS_H
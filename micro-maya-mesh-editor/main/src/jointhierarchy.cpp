@@ -0,0 +1,82 @@
+#include "jointhierarchy.h"
+#include <algorithm>
+
+JointHierarchy::JointHierarchy()
+    : anyDirty(false)
+{}
+
+int JointHierarchy::addJoint(int parentIndex, const glm::vec3 &position, const glm::quat &rotation) {
+    parent.push_back(parentIndex);
+    pos.push_back(position);
+    rot.push_back(rotation);
+    bind.push_back(glm::mat4());
+    local.push_back(glm::mat4());
+    world.push_back(glm::mat4());
+    dirty.push_back(true);
+    anyDirty = true;
+    return parent.size() - 1;
+}
+
+void JointHierarchy::clear() {
+    parent.clear();
+    pos.clear();
+    rot.clear();
+    bind.clear();
+    local.clear();
+    world.clear();
+    dirty.clear();
+    anyDirty = false;
+}
+
+void JointHierarchy::setPosition(int joint, const glm::vec3 &position) {
+    pos[joint] = position;
+    dirty[joint] = true;
+    anyDirty = true;
+}
+
+void JointHierarchy::setRotation(int joint, const glm::quat &rotation) {
+    rot[joint] = rotation;
+    dirty[joint] = true;
+    anyDirty = true;
+}
+
+void JointHierarchy::update() {
+    if (!anyDirty) return;
+
+    // Parents come first, so a joint knows whether its parent changed by the time it is visited
+    for (int i = 0; i < size(); i++) {
+        bool parentDirty = parent[i] >= 0 && dirty[parent[i]];
+        if (!dirty[i] && !parentDirty) continue;
+
+        if (dirty[i]) {
+            local[i] = glm::translate(glm::mat4(1.f), pos[i]) * glm::toMat4(rot[i]);
+        }
+        world[i] = parent[i] >= 0 ? world[parent[i]] * local[i] : local[i];
+        dirty[i] = true;
+    }
+
+    std::fill(dirty.begin(), dirty.end(), false);
+    anyDirty = false;
+}
+
+const glm::mat4 &JointHierarchy::getLocalTransformation(int joint) {
+    update();
+    return local[joint];
+}
+
+const glm::mat4 &JointHierarchy::getOverallTransformation(int joint) {
+    update();
+    return world[joint];
+}
+
+const std::vector<glm::mat4> &JointHierarchy::getTransformations() {
+    update();
+    return world;
+}
+
+void JointHierarchy::bindPose() {
+    update();
+    for (int i = 0; i < size(); i++) {
+        bind[i] = glm::inverse(world[i]);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef JOINTHIERARCHY_H
+#define JOINTHIERARCHY_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <vector>
+
+// The joints of a skeleton as parallel arrays, every parent stored before its children.
+// Local and world transformations are cached. Editing a joint marks it dirty and update()
+// recomputes, in one forward pass, only the joints whose own or ancestor's transformation changed.
+class JointHierarchy
+{
+public:
+    JointHierarchy();
+
+    // The index of each joint's parent, -1 for a root
+    std::vector<int> parent;
+    // The position of each joint relative to its parent joint
+    std::vector<glm::vec3> pos;
+    // The quaternion that represents each joint's current orientation
+    std::vector<glm::quat> rot;
+    // The inverse of each joint's world transformation at the time a mesh is bound to the skeleton
+    std::vector<glm::mat4> bind;
+
+    int size() const { return parent.size(); }
+
+    // Append a joint, parentIndex must already exist. Returns the new joint's index.
+    int addJoint(int parentIndex, const glm::vec3 &position, const glm::quat &rotation);
+    void clear();
+
+    void setPosition(int joint, const glm::vec3 &position);
+    void setRotation(int joint, const glm::quat &rotation);
+
+    // Recompute the cached transformations of the dirty joints and their descendants
+    void update();
+
+    // The concatenation of a joint's position and rotation
+    const glm::mat4 &getLocalTransformation(int joint);
+    // The concatenation of a joint's local transformation with those of its chain of parents
+    const glm::mat4 &getOverallTransformation(int joint);
+    // Every joint's overall transformation, indexed by joint
+    const std::vector<glm::mat4> &getTransformations();
+
+    // Set every joint's bind matrix to the inverse of its current world transformation
+    void bindPose();
+
+private:
+    std::vector<glm::mat4> local;
+    std::vector<glm::mat4> world;
+    std::vector<char> dirty;
+    bool anyDirty;
+};
+
+#endif // JOINTHIERARCHY_H
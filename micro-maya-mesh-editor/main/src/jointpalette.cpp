@@ -0,0 +1,69 @@
+#include "jointpalette.h"
+#include <algorithm>
+#include <cstring>
+
+JointPalette::JointPalette(OpenGLContext *context)
+    : buffer(), texture(), created(false), uploaded(), mp_context(context)
+{}
+
+JointPalette::~JointPalette() {
+    destroy();
+}
+
+void JointPalette::create() {
+    if (created) return;
+    mp_context->glGenBuffers(1, &buffer);
+    mp_context->glGenTextures(1, &texture);
+    created = true;
+}
+
+void JointPalette::destroy() {
+    if (!created) return;
+    mp_context->glDeleteBuffers(1, &buffer);
+    mp_context->glDeleteTextures(1, &texture);
+    uploaded.clear();
+    created = false;
+}
+
+void JointPalette::upload(const std::vector<glm::mat4> &palette) {
+    upload(reinterpret_cast<const char*>(palette.data()), palette.size(), sizeof(glm::mat4));
+}
+
+void JointPalette::upload(const std::vector<DualQuat> &palette) {
+    upload(reinterpret_cast<const char*>(palette.data()), palette.size(), sizeof(DualQuat));
+}
+
+void JointPalette::upload(const char *palette, size_t count, size_t jointSize) {
+    if (!created || count == 0) return;
+
+    mp_context->glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+
+    const size_t size = count * jointSize;
+    if (size != uploaded.size()) {
+        mp_context->glBufferData(GL_TEXTURE_BUFFER, size, palette, GL_DYNAMIC_DRAW);
+        // The texture has to be attached again after the buffer's storage changed
+        mp_context->glBindTexture(GL_TEXTURE_BUFFER, texture);
+        mp_context->glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+        uploaded.assign(palette, palette + size);
+        return;
+    }
+
+    for (size_t begin = 0; begin < count;) {
+        if (std::memcmp(palette + begin * jointSize, &uploaded[begin * jointSize], jointSize) == 0) {
+            begin++;
+            continue;
+        }
+        size_t end = begin + 1;
+        while (end < count && std::memcmp(palette + end * jointSize, &uploaded[end * jointSize], jointSize) != 0) end++;
+
+        mp_context->glBufferSubData(GL_TEXTURE_BUFFER, begin * jointSize,
+                                    (end - begin) * jointSize, palette + begin * jointSize);
+        std::copy(palette + begin * jointSize, palette + end * jointSize, uploaded.begin() + begin * jointSize);
+        begin = end;
+    }
+}
+
+void JointPalette::bind(int unit) {
+    mp_context->glActiveTexture(GL_TEXTURE0 + unit);
+    mp_context->glBindTexture(GL_TEXTURE_BUFFER, texture);
+}
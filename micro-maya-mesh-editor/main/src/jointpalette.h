@@ -0,0 +1,46 @@
+#ifndef JOINTPALETTE_H
+#define JOINTPALETTE_H
+
+#include <openglcontext.h>
+#include <la.h>
+#include "skinning.h"
+#include <vector>
+
+// The skinning transformations (transformation * bind) of every joint, stored on the GPU in a
+// texture buffer that the skeleton shaders read with texelFetch. Unlike a uniform array this
+// has no fixed joint count. For skeleton.vert.glsl each matrix takes four RGBA32F texels, one per
+// column, for skeleton_dq.vert.glsl each dual quaternion takes two, its real then its dual part.
+class JointPalette
+{
+public:
+    JointPalette(OpenGLContext *context);
+    ~JointPalette();
+
+    // Allocate the buffer and its texture
+    void create();
+    // Free the buffer and its texture
+    void destroy();
+
+    // Upload palette. Only the runs of joints whose transformation differs from the last upload are
+    // sent with glBufferSubData, the whole buffer is reallocated when its size changes.
+    void upload(const std::vector<glm::mat4> &palette);
+    void upload(const std::vector<DualQuat> &palette);
+
+    // Bind the texture to GL_TEXTURE_BUFFER on the given texture unit
+    void bind(int unit);
+
+private:
+    GLuint buffer;
+    GLuint texture;
+    bool created;
+
+    // What the GPU currently holds
+    std::vector<char> uploaded;
+
+    // Upload count joints of jointSize bytes each
+    void upload(const char *palette, size_t count, size_t jointSize);
+
+    OpenGLContext *mp_context;
+};
+
+#endif // JOINTPALETTE_H
@@ -0,0 +1,74 @@
+#include "kdtree.h"
+#include <algorithm>
+
+KdTree::KdTree()
+{}
+
+void KdTree::build(const std::vector<glm::vec3> &points) {
+    nodes.resize(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        nodes[i] = {points[i], (int)i, -1};
+    }
+    build(0, nodes.size());
+}
+
+void KdTree::build(int begin, int end) {
+    if (end - begin <= 1) return;
+
+    // Split along the axis of largest extent
+    glm::vec3 lo = nodes[begin].pos;
+    glm::vec3 hi = nodes[begin].pos;
+    for (int i = begin + 1; i < end; i++) {
+        lo = glm::min(lo, nodes[i].pos);
+        hi = glm::max(hi, nodes[i].pos);
+    }
+    glm::vec3 extent = hi - lo;
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+    int mid = (begin + end) / 2;
+    std::nth_element(nodes.begin() + begin, nodes.begin() + mid, nodes.begin() + end,
+                     [axis](const Node &a, const Node &b) { return a.pos[axis] < b.pos[axis]; });
+    nodes[mid].axis = axis;
+
+    build(begin, mid);
+    build(mid + 1, end);
+}
+
+int KdTree::nearest(const glm::vec3 &query, int k, std::pair<int, float> *out) const {
+    int found = 0;
+    if (k > 0) search(0, nodes.size(), query, k, out, found);
+    return found;
+}
+
+void KdTree::search(int begin, int end, const glm::vec3 &query, int k,
+                    std::pair<int, float> *out, int &found) const {
+    if (begin >= end) return;
+
+    int mid = (begin + end) / 2;
+    const Node &node = nodes[mid];
+
+    // Insert the node into the sorted list of the k best so far
+    glm::vec3 d = query - node.pos;
+    float dist = glm::dot(d, d);
+    if (found < k || dist < out[found - 1].second) {
+        int i = found < k ? found++ : k - 1;
+        for (; i > 0 && out[i - 1].second > dist; i--) {
+            out[i] = out[i - 1];
+        }
+        out[i] = {node.index, dist};
+    }
+
+    if (node.axis < 0) return;
+
+    // Visit the side of the query first, the other one only if it can hold a closer point
+    float delta = query[node.axis] - node.pos[node.axis];
+    int nearBegin = delta < 0 ? begin : mid + 1;
+    int nearEnd = delta < 0 ? mid : end;
+    int farBegin = delta < 0 ? mid + 1 : begin;
+    int farEnd = delta < 0 ? end : mid;
+
+    search(nearBegin, nearEnd, query, k, out, found);
+    if (found < k || delta * delta < out[found - 1].second) {
+        search(farBegin, farEnd, query, k, out, found);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+// A static 3D k-d tree for k-nearest-neighbor queries over a small point set, such as joint positions.
+// The tree is stored implicitly: each node is the median of its range of the reordered point array.
+class KdTree
+{
+public:
+    KdTree();
+
+    // Build the tree over points, replacing any previous content
+    void build(const std::vector<glm::vec3> &points);
+
+    // Find the k points closest to query and write (point index, squared distance) pairs to out,
+    // nearest first. Returns the number of pairs written, min(k, number of points).
+    // Safe to call from several threads at once.
+    int nearest(const glm::vec3 &query, int k, std::pair<int, float> *out) const;
+
+private:
+    struct Node {
+        glm::vec3 pos;
+        int index; // Index of the point in the array given to build()
+        int axis;  // Splitting axis, -1 for a leaf
+    };
+    std::vector<Node> nodes;
+
+    void build(int begin, int end);
+    void search(int begin, int end, const glm::vec3 &query, int k, std::pair<int, float> *out, int &found) const;
+};
+
+#endif // KDTREE_H
@@ -1,7 +1,6 @@
 #ifndef LA
 #define LA
 #define GLM_CIS460  // Don't copy this include!
-#define GLM_FORCE_RADIANS
 // Primary GLM library
 #    include <glm/glm.hpp>
 // For glm::translate, glm::rotate, and glm::scale.
@@ -1,34 +1,92 @@
 #include "mainwindow.h"
 #include <ui_mainwindow.h>
 #include "cameracontrolshelp.h"
+#include <QSignalBlocker>
 
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    m_vertsModel(new ComponentListModel(this)),
+    m_halfEdgesModel(new ComponentListModel(this)),
+    m_facesModel(new ComponentListModel(this))
 {
     ui->setupUi(this);
     ui->mygl->setFocus();
+    ui->vertsListView->setModel(m_vertsModel);
+    ui->halfEdgesListView->setModel(m_halfEdgesModel);
+    ui->facesListView->setModel(m_facesModel);
+    // Edit Menu
+    connect(ui->actionUndo, SIGNAL(triggered()),
+            ui->mygl, SLOT(slot_undo()));
+    connect(ui->actionRedo, SIGNAL(triggered()),
+            ui->mygl, SLOT(slot_redo()));
     // Function Button
     connect(ui->loadMeshButton, SIGNAL(clicked(bool)),
             ui->mygl, SLOT(slot_loadMesh()));
+    connect(ui->exportMeshButton, SIGNAL(clicked(bool)),
+            ui->mygl, SLOT(slot_exportMesh()));
+    connect(ui->exportPosedCheckBox, SIGNAL(toggled(bool)),
+            ui->mygl, SLOT(slot_setExportPosed(bool)));
     connect(ui->loadSkeletonButton, SIGNAL(clicked(bool)),
             ui->mygl, SLOT(slot_loadSkeleton()));
     connect(ui->addVertexButton, SIGNAL(clicked(bool)),
             ui->mygl, SLOT(slot_addVertex()));
     connect(ui->triangulateButton, SIGNAL(clicked(bool)),
             ui->mygl, SLOT(slot_triangulate()));
+    connect(ui->triangulateAllButton, SIGNAL(clicked(bool)),
+            ui->mygl, SLOT(slot_triangulateAll()));
     connect(ui->subdivisionButton, SIGNAL(clicked(bool)),
             ui->mygl, SLOT(slot_subdivision()));
+    connect(ui->subdivideFaceButton, SIGNAL(clicked(bool)),
+            ui->mygl, SLOT(slot_subdivideFace()));
+    connect(ui->subdivisionLevelsSpinBox, SIGNAL(valueChanged(int)),
+            ui->mygl, SLOT(slot_setSubdivisionLevels(int)));
+    connect(ui->smoothCheckBox, SIGNAL(toggled(bool)),
+            ui->mygl, SLOT(slot_setSmooth(bool)));
     connect(ui->BindMeshButton, SIGNAL(clicked(bool)),
             ui->mygl, SLOT(slot_bindMesh()));
+    connect(ui->bindInfluencesSpinBox, SIGNAL(valueChanged(int)),
+            ui->mygl, SLOT(slot_setBindInfluences(int)));
+    connect(ui->cpuSkinningCheckBox, SIGNAL(toggled(bool)),
+            ui->mygl, SLOT(slot_setCpuSkinning(bool)));
+    connect(ui->dualQuatCheckBox, SIGNAL(toggled(bool)),
+            ui->mygl, SLOT(slot_setDualQuatSkinning(bool)));
+    connect(ui->instancedGizmosCheckBox, SIGNAL(toggled(bool)),
+            ui->mygl, SLOT(slot_setInstancedGizmos(bool)));
+    connect(ui->loadClipButton, SIGNAL(clicked(bool)),
+            ui->mygl, SLOT(slot_loadClip()));
+    connect(ui->playCheckBox, SIGNAL(toggled(bool)),
+            ui->mygl, SLOT(slot_setPlaying(bool)));
+    connect(ui->cachePosesCheckBox, SIGNAL(toggled(bool)),
+            ui->mygl, SLOT(slot_setCachePoses(bool)));
+    connect(ui->lodCheckBox, SIGNAL(toggled(bool)),
+            ui->mygl, SLOT(slot_setLod(bool)));
+    connect(ui->lodTrianglesSpinBox, SIGNAL(valueChanged(int)),
+            ui->mygl, SLOT(slot_setLodTriangles(int)));
     // Update Visual Display
-    connect(ui->vertsListWidget, SIGNAL(itemClicked(QListWidgetItem*)),
-            ui->mygl, SLOT(slot_setChosenVertex(QListWidgetItem*)));
-    connect(ui->facesListWidget, SIGNAL(itemClicked(QListWidgetItem*)),
-            ui->mygl, SLOT(slot_setChosenFace(QListWidgetItem*)));
-    connect(ui->halfEdgesListWidget, SIGNAL(itemClicked(QListWidgetItem*)),
-            ui->mygl, SLOT(slot_setChosenHalfEdge(QListWidgetItem*)));
+    connect(ui->vertsListView, SIGNAL(clicked(QModelIndex)),
+            ui->mygl, SLOT(slot_setChosenVertex(QModelIndex)));
+    connect(ui->facesListView, SIGNAL(clicked(QModelIndex)),
+            ui->mygl, SLOT(slot_setChosenFace(QModelIndex)));
+    connect(ui->halfEdgesListView, SIGNAL(clicked(QModelIndex)),
+            ui->mygl, SLOT(slot_setChosenHalfEdge(QModelIndex)));
+    // Jump to id
+    connect(ui->vertsJumpLineEdit, &QLineEdit::returnPressed, [this]() {
+        jumpToId(ui->vertsJumpLineEdit, ui->vertsListView, &MyGL::slot_setChosenVertex);
+    });
+    connect(ui->halfEdgesJumpLineEdit, &QLineEdit::returnPressed, [this]() {
+        jumpToId(ui->halfEdgesJumpLineEdit, ui->halfEdgesListView, &MyGL::slot_setChosenHalfEdge);
+    });
+    connect(ui->facesJumpLineEdit, &QLineEdit::returnPressed, [this]() {
+        jumpToId(ui->facesJumpLineEdit, ui->facesListView, &MyGL::slot_setChosenFace);
+    });
+    // Mouse picking in the viewport
+    connect(ui->mygl, &MyGL::sig_picked, [this](uint32_t vert, uint32_t halfEdge, uint32_t face) {
+        selectId(face, ui->facesListView, &MyGL::slot_setChosenFace);
+        selectId(halfEdge, ui->halfEdgesListView, &MyGL::slot_setChosenHalfEdge);
+        selectId(vert, ui->vertsListView, &MyGL::slot_setChosenVertex);
+    });
     connect(ui->jointsTreeWidget, SIGNAL(itemClicked(QTreeWidgetItem*, int)),
             ui->mygl, SLOT(slot_setChosenJoint(QTreeWidgetItem*)));
     // Update List Display
@@ -37,12 +95,15 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->mygl, SIGNAL(sig_buildJointList(Skeleton*)),
             this, SLOT(slot_buildJointList(Skeleton*)));
     // Update Value Display
+    // Showing a value is not an edit, so the spin boxes stay silent while they are set
     connect(ui->mygl, &MyGL::sig_updatePosition, [this](const QVector3D& position) {
+        QSignalBlocker blockX(ui->vertPosXSpinBox), blockY(ui->vertPosYSpinBox), blockZ(ui->vertPosZSpinBox);
         ui->vertPosXSpinBox->setValue(position.x());
         ui->vertPosYSpinBox->setValue(position.y());
         ui->vertPosZSpinBox->setValue(position.z());
     });
     connect(ui->mygl, &MyGL::sig_updateColor, [this](const QColor& color) {
+        QSignalBlocker blockR(ui->faceRedSpinBox), blockG(ui->faceGreenSpinBox), blockB(ui->faceBlueSpinBox);
         ui->faceRedSpinBox->setValue(color.redF());
         ui->faceGreenSpinBox->setValue(color.greenF());
         ui->faceBlueSpinBox->setValue(color.blueF());
@@ -111,15 +172,27 @@ void MainWindow::on_actionCamera_Controls_triggered()
 
 void MainWindow::slot_buildComponentList(Mesh* mesh)
 {
-    for (auto& vert : mesh->verts) {
-        ui->vertsListWidget->addItem(vert.get());
-    }
-    for (auto& edge : mesh->edges) {
-        ui->halfEdgesListWidget->addItem(edge.get());
-    }
-    for (auto& face : mesh->faces) {
-        ui->facesListWidget->addItem(face.get());
-    }
+    m_vertsModel->setCount(mesh->numVerts());
+    m_halfEdgesModel->setCount(mesh->numHalfEdges());
+    m_facesModel->setCount(mesh->numFaces());
+}
+
+void MainWindow::jumpToId(QLineEdit *lineEdit, QListView *view, void (MyGL::*select)(const QModelIndex&))
+{
+    bool ok;
+    int id = lineEdit->text().toInt(&ok);
+    if (!ok) return;
+    selectId(id, view, select);
+}
+
+void MainWindow::selectId(int id, QListView *view, void (MyGL::*select)(const QModelIndex&))
+{
+    if (id < 0 || id >= view->model()->rowCount()) return;
+
+    QModelIndex index = view->model()->index(id, 0);
+    view->setCurrentIndex(index);
+    view->scrollTo(index, QAbstractItemView::PositionAtCenter);
+    (ui->mygl->*select)(index);
 }
 
 void MainWindow::slot_buildJointList(Skeleton* skeleton)
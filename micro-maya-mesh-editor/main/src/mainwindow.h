@@ -1,6 +1,7 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "componentlistmodel.h"
 #include "mesh.h"
 #include "skeleton.h"
 #include <QMainWindow>
@@ -10,6 +11,10 @@ namespace Ui {
 class MainWindow;
 }
 
+class MyGL;
+class QLineEdit;
+class QListView;
+
 
 class MainWindow : public QMainWindow
 {
@@ -30,6 +35,16 @@ private slots:
 
 private:
     Ui::MainWindow *ui;
+
+    // Rows of the vertex, half-edge and face lists
+    ComponentListModel *m_vertsModel;
+    ComponentListModel *m_halfEdgesModel;
+    ComponentListModel *m_facesModel;
+
+    // Select and show the row of the id typed in a list's line edit
+    void jumpToId(QLineEdit *lineEdit, QListView *view, void (MyGL::*select)(const QModelIndex&));
+    // Select and show the row id of a list
+    void selectId(int id, QListView *view, void (MyGL::*select)(const QModelIndex&));
 };
 
 
@@ -2,19 +2,18 @@
 #define MESH_H
 
 #include "drawable.h"
-#include "smartpointerhelp.h"
-#include "face.h"
-#include "vertex.h"
-#include "halfedge.h"
+#include "halfedgemesh.h"
+#include "meshbuffers.h"
 
-class Mesh : public Drawable
+// The half-edge mesh the editor displays. All topology lives in HalfEdgeMesh,
+// this class only turns it into VBOs.
+class Mesh : public Drawable, public HalfEdgeMesh
 {
 public:
     Mesh(OpenGLContext* context);
 
-    std::vector<uPtr<Face>> faces;
-    std::vector<uPtr<HalfEdge>> edges;
-    std::vector<uPtr<Vertex>> verts;
+    // CPU copy of the VBO data, kept to update it in place
+    MeshBuffers buffers;
 
     // Populates the VBOs of the Drawable.
     void create() override;
@@ -22,19 +21,12 @@ public:
     // return GL_TRIANGLES
     GLenum drawMode() override;
 
-    void addVertex(HalfEdge *edge);
-    void triangulate(Face *face);
-    void subdivision();
+    // Record that a vertex moved or a face changed color since the last create()
+    void markVertexDirty(uint32_t vert);
+    void markFaceDirty(uint32_t face);
 
-    static glm::vec3 getRandomColor();
-
-private:
-    void addCentroid(Face *face, std::unordered_map<int, Vertex*> &map);
-    void addMidpoint(HalfEdge* edge, std::unordered_map<int, Vertex*> &map);
-    void smoothVertex(Vertex *vert, std::unordered_map<int, Vertex*> &map);
-    void quadrangulate(Face *face, Vertex *centroid,
-                       std::vector<HalfEdge*> &originEdges,
-                       std::vector<HalfEdge*> &newEdges);
+    // Recompute and upload with glBufferSubData only the face corners touched by the marked edits
+    void updateDirty();
 };
 
 #endif // MESH_H
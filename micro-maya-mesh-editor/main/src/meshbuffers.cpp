@@ -0,0 +1,194 @@
+#include "meshbuffers.h"
+#include "parallel.h"
+#include <algorithm>
+
+MeshBuffers::MeshBuffers()
+    : smooth(false)
+{}
+
+void MeshBuffers::build(const HalfEdgeMesh &mesh) {
+    const uint32_t numFaces = mesh.numFaces();
+
+    faceCorner.resize(numFaces + 1);
+    uint32_t corner = 0;
+    for (uint32_t face = 0; face < numFaces; face++) {
+        faceCorner[face] = corner;
+        corner += mesh.faceDegree(face);
+    }
+    faceCorner[numFaces] = corner;
+
+    const uint32_t numEntries = smooth ? mesh.numVerts() : corner;
+    positions.resize(numEntries);
+    colors.resize(numEntries);
+    normals.resize(numEntries);
+    joints.resize(numEntries);
+    weights.resize(numEntries);
+
+    if (smooth) {
+        faceNormals.resize(numFaces);
+        parallelFor(0, numFaces, [&](uint32_t face) { writeFaceNormal(mesh, face); });
+        parallelFor(0, mesh.numVerts(), [&](uint32_t vert) { writeVertex(mesh, vert); });
+    } else {
+        faceNormals.clear();
+        parallelFor(0, numFaces, [&](uint32_t face) { writeFace(mesh, face); });
+    }
+
+    // A face of n corners is n - 2 triangles, fanned around its first corner
+    indices.resize(3 * (corner - 2 * numFaces));
+    parallelFor(0, numFaces, [&](uint32_t face) {
+        uint32_t idx = faceCorner[face];
+        uint32_t edgeCount = faceCorner[face + 1] - idx;
+        uint32_t *out = &indices[3 * (idx - 2 * face)];
+
+        if (smooth) {
+            uint32_t first = mesh.faceEdge[face];
+            uint32_t edge = mesh.heNext[first];
+            for (uint32_t i = 0; i + 2 < edgeCount; i++) {
+                *out++ = mesh.heVert[first];
+                *out++ = mesh.heVert[edge];
+                edge = mesh.heNext[edge];
+                *out++ = mesh.heVert[edge];
+            }
+        } else {
+            for (uint32_t i = 0; i + 2 < edgeCount; i++) {
+                *out++ = idx;
+                *out++ = idx + i + 1;
+                *out++ = idx + i + 2;
+            }
+        }
+    }, 1024);
+
+    dirtyFaces.clear();
+    dirtyAttributes.assign(numFaces, 0);
+}
+
+void MeshBuffers::writeSkin(const HalfEdgeMesh &mesh, uint32_t vert, uint32_t entry) {
+    // Entries of unbound vertices get all-zero weights
+    const SkinInfluences &skin = mesh.vertSkin[vert];
+    joints[entry] = glm::u16vec4(skin.joint[0], skin.joint[1], skin.joint[2], skin.joint[3]);
+    weights[entry] = glm::u16vec4(skin.weight[0], skin.weight[1], skin.weight[2], skin.weight[3]);
+}
+
+void MeshBuffers::writeFace(const HalfEdgeMesh &mesh, uint32_t face) {
+    uint32_t corner = faceCorner[face];
+    uint32_t edge = mesh.faceEdge[face];
+
+    // One normal for the whole face. A corner's own cross product vanishes where it is
+    // collinear with its neighbors, as on the edge points a region subdivision inserts.
+    glm::vec3 normal = newellNormal(mesh, face);
+    normal = glm::length(normal) > 0.f ? glm::normalize(normal) : normal;
+
+    // Set up pos, color, normal for every vertex on each edge
+    do {
+        uint32_t vert = mesh.heVert[edge];
+        positions[corner] = glm::vec4(mesh.position(vert), 1);
+        colors[corner] = glm::vec4(mesh.faceColor[face], 1);
+        normals[corner] = glm::vec4(normal, 0);
+        writeSkin(mesh, vert, corner);
+
+        edge = mesh.heNext[edge];
+        corner++;
+    } while (edge != mesh.faceEdge[face]);
+}
+
+void MeshBuffers::writeFaceNormal(const HalfEdgeMesh &mesh, uint32_t face) {
+    faceNormals[face] = newellNormal(mesh, face);
+}
+
+glm::vec3 MeshBuffers::newellNormal(const HalfEdgeMesh &mesh, uint32_t face) {
+    // Newell's method, also correct for non-planar and concave polygons
+    glm::vec3 normal(0.f);
+    uint32_t edge = mesh.faceEdge[face];
+    do {
+        glm::vec3 a = mesh.position(mesh.heVert[edge]);
+        glm::vec3 b = mesh.position(mesh.heVert[mesh.heNext[edge]]);
+        normal += glm::cross(a, b);
+        edge = mesh.heNext[edge];
+    } while (edge != mesh.faceEdge[face]);
+    return normal;
+}
+
+void MeshBuffers::writeVertex(const HalfEdgeMesh &mesh, uint32_t vert) {
+    // Gather from the faces around the vertex, so vertices can be written in parallel
+    glm::vec3 normal(0.f);
+    glm::vec3 color(0.f);
+    float numFaces = 0.f;
+    mesh.forEachIncoming(vert, [&](uint32_t edge) {
+        normal += faceNormals[mesh.heFace[edge]];
+        color += mesh.faceColor[mesh.heFace[edge]];
+        numFaces += 1.f;
+    });
+
+    positions[vert] = glm::vec4(mesh.position(vert), 1);
+    colors[vert] = glm::vec4(numFaces > 0.f ? color / numFaces : glm::vec3(0.f), 1);
+    normals[vert] = glm::vec4(glm::length(normal) > 0.f ? glm::normalize(normal) : normal, 0);
+    writeSkin(mesh, vert, vert);
+}
+
+void MeshBuffers::markFace(uint32_t face, int attributes) {
+    if (face >= dirtyAttributes.size()) return;
+    if (dirtyAttributes[face] == 0) dirtyFaces.push_back(face);
+    dirtyAttributes[face] |= attributes;
+}
+
+void MeshBuffers::markFace(uint32_t face) {
+    markFace(face, COLOR);
+}
+
+void MeshBuffers::markVertex(const HalfEdgeMesh &mesh, uint32_t vert) {
+    // Each HalfEdge pointing to vert lies on a face around it
+    mesh.forEachIncoming(vert, [&](uint32_t edge) {
+        markFace(mesh.heFace[edge], POSITION | NORMAL);
+    });
+}
+
+bool MeshBuffers::isDirty() const {
+    return !dirtyFaces.empty();
+}
+
+void MeshBuffers::addRange(std::vector<CornerRange> &ranges, const CornerRange &r, uint32_t mergeGap) {
+    if (!ranges.empty() && r.begin <= ranges.back().end + mergeGap) {
+        ranges.back().end = std::max(ranges.back().end, r.end);
+        ranges.back().attributes |= r.attributes;
+    } else {
+        ranges.push_back(r);
+    }
+}
+
+std::vector<MeshBuffers::CornerRange> MeshBuffers::rebuildDirty(const HalfEdgeMesh &mesh, uint32_t mergeGap) {
+    std::vector<CornerRange> ranges;
+
+    if (smooth) {
+        // Every vertex of a dirty face takes part of its normal and color
+        std::vector<std::pair<uint32_t, int>> verts;
+        for (uint32_t face : dirtyFaces) {
+            if (dirtyAttributes[face] & NORMAL) writeFaceNormal(mesh, face);
+            uint32_t edge = mesh.faceEdge[face];
+            do {
+                verts.push_back({mesh.heVert[edge], dirtyAttributes[face]});
+                edge = mesh.heNext[edge];
+            } while (edge != mesh.faceEdge[face]);
+            dirtyAttributes[face] = 0;
+        }
+        std::sort(verts.begin(), verts.end());
+
+        for (size_t i = 0; i < verts.size();) {
+            uint32_t vert = verts[i].first;
+            int attributes = 0;
+            for (; i < verts.size() && verts[i].first == vert; i++) attributes |= verts[i].second;
+
+            writeVertex(mesh, vert);
+            addRange(ranges, {vert, vert + 1, attributes}, mergeGap);
+        }
+    } else {
+        std::sort(dirtyFaces.begin(), dirtyFaces.end());
+        for (uint32_t face : dirtyFaces) {
+            writeFace(mesh, face);
+            addRange(ranges, {faceCorner[face], faceCorner[face + 1], dirtyAttributes[face]}, mergeGap);
+            dirtyAttributes[face] = 0;
+        }
+    }
+
+    dirtyFaces.clear();
+    return ranges;
+}
@@ -0,0 +1,83 @@
+#ifndef MESHBUFFERS_H
+#define MESHBUFFERS_H
+
+#include "halfedgemesh.h"
+#include <glm/gtc/type_precision.hpp>
+
+// The CPU side of the Mesh VBOs and a triangle fan of indices per face.
+// In flat mode there is one VBO entry per face corner, the corners of each face stored
+// contiguously in face order, with the face's normal and color.
+// In smooth mode the corners are welded into one entry per mesh vertex, with the
+// area-weighted average of the normals and colors of the faces around it.
+// Edits mark the elements they touch and rebuildDirty() recomputes only the entries they
+// affect, returning the ranges that have to be uploaded again.
+// Nothing here depends on OpenGL, so the diffing can be exercised without a GPU.
+class MeshBuffers
+{
+public:
+    // Which attributes of a range of entries changed
+    enum Attribute {
+        POSITION = 1 << 0,
+        NORMAL = 1 << 1,
+        COLOR = 1 << 2
+    };
+
+    // Entries [begin, end) whose attributes in the mask changed
+    struct CornerRange {
+        uint32_t begin;
+        uint32_t end;
+        int attributes;
+    };
+
+    MeshBuffers();
+
+    // Weld face corners into shared vertices, takes effect on the next build()
+    bool smooth;
+
+    std::vector<glm::vec4> positions;
+    std::vector<glm::vec4> colors;
+    std::vector<glm::vec4> normals;
+    // Skin influences as uint16 joint indices and unorm16 weights
+    std::vector<glm::u16vec4> joints;
+    std::vector<glm::u16vec4> weights;
+    std::vector<uint32_t> indices;
+
+    // The first corner of each face, plus one past the last corner of the last face
+    std::vector<uint32_t> faceCorner;
+
+    // Rebuild every array from the mesh and forget any pending edit
+    void build(const HalfEdgeMesh &mesh);
+
+    // A vertex moved: the positions and normals of every face around it change
+    void markVertex(const HalfEdgeMesh &mesh, uint32_t vert);
+    // A face changed color
+    void markFace(uint32_t face);
+    bool isDirty() const;
+
+    // Recompute the entries affected by the marked faces and return the merged ranges to upload.
+    // Ranges closer than mergeGap entries are uploaded as one.
+    std::vector<CornerRange> rebuildDirty(const HalfEdgeMesh &mesh, uint32_t mergeGap = 64);
+
+private:
+    // Faces that need their entries recomputed, with the attributes that changed
+    std::vector<uint32_t> dirtyFaces;
+    std::vector<int> dirtyAttributes;
+
+    // Smooth mode: each face's Newell normal, whose length is twice the face's area
+    std::vector<glm::vec3> faceNormals;
+
+    void markFace(uint32_t face, int attributes);
+    // Flat mode: write the corners of one face at faceCorner[face]
+    void writeFace(const HalfEdgeMesh &mesh, uint32_t face);
+    // Smooth mode
+    void writeFaceNormal(const HalfEdgeMesh &mesh, uint32_t face);
+    // The Newell normal of a face, unnormalized
+    static glm::vec3 newellNormal(const HalfEdgeMesh &mesh, uint32_t face);
+    void writeVertex(const HalfEdgeMesh &mesh, uint32_t vert);
+    void writeSkin(const HalfEdgeMesh &mesh, uint32_t vert, uint32_t entry);
+
+    // Append r to ranges, merging it with the last range if they are close enough
+    static void addRange(std::vector<CornerRange> &ranges, const CornerRange &r, uint32_t mergeGap);
+};
+
+#endif // MESHBUFFERS_H
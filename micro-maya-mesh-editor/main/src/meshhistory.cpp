@@ -0,0 +1,321 @@
+#include "meshhistory.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+// Order the saves of one kind of element by index, and keep only the first save of each element,
+// which holds its value from before the edit, if the element changed since
+template<typename State, typename Get>
+void keepChanged(std::vector<uint32_t> &indices, std::vector<State> &states, const Get &current) {
+    if (!std::is_sorted(indices.begin(), indices.end())) {
+        std::vector<uint32_t> order(indices.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return indices[a] < indices[b];
+        });
+        std::vector<uint32_t> sortedIndices(indices.size());
+        std::vector<State> sortedStates(states.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            sortedIndices[i] = indices[order[i]];
+            sortedStates[i] = states[order[i]];
+        }
+        indices.swap(sortedIndices);
+        states.swap(sortedStates);
+    }
+
+    size_t kept = 0;
+    uint32_t previous = NO_INDEX;
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (indices[i] == previous) continue;
+        previous = indices[i];
+        State now = current(indices[i]);
+        if (std::memcmp(&now, &states[i], sizeof(State)) == 0) continue;
+        indices[kept] = indices[i];
+        states[kept] = states[i];
+        kept++;
+    }
+    indices.resize(kept);
+    indices.shrink_to_fit();
+    states.resize(kept);
+    states.shrink_to_fit();
+}
+
+template<typename T>
+size_t bytes(const std::vector<T> &v) {
+    return v.capacity() * sizeof(T);
+}
+
+} // namespace
+
+size_t MeshHistory::Edit::memoryUsage() const {
+    return sizeof(Edit) + bytes(verts) + bytes(vertStates) + bytes(halfEdges) + bytes(halfEdgeStates) +
+           bytes(faces) + bytes(faceStates) + bytes(addedVerts) + bytes(addedHalfEdges) + bytes(addedFaces);
+}
+
+MeshHistory::MeshHistory(size_t memoryLimit)
+    : recording(nullptr), current(), undoStack(), redoStack(), change(), memoryLimit(memoryLimit), usedBytes(0)
+{}
+
+MeshHistory::VertexState MeshHistory::getVertex(const HalfEdgeMesh &mesh, uint32_t vert) {
+    return {mesh.posX[vert], mesh.posY[vert], mesh.posZ[vert], mesh.vertEdge[vert], mesh.vertSkin[vert]};
+}
+
+MeshHistory::HalfEdgeState MeshHistory::getHalfEdge(const HalfEdgeMesh &mesh, uint32_t edge) {
+    return {mesh.heNext[edge], mesh.heSym[edge], mesh.heFace[edge], mesh.heVert[edge]};
+}
+
+MeshHistory::FaceState MeshHistory::getFace(const HalfEdgeMesh &mesh, uint32_t face) {
+    return {mesh.faceEdge[face], mesh.faceColor[face]};
+}
+
+void MeshHistory::setVertex(HalfEdgeMesh &mesh, uint32_t vert, const VertexState &state) {
+    mesh.posX[vert] = state.x;
+    mesh.posY[vert] = state.y;
+    mesh.posZ[vert] = state.z;
+    mesh.vertEdge[vert] = state.edge;
+    mesh.vertSkin[vert] = state.skin;
+}
+
+void MeshHistory::setHalfEdge(HalfEdgeMesh &mesh, uint32_t edge, const HalfEdgeState &state) {
+    mesh.heNext[edge] = state.next;
+    mesh.heSym[edge] = state.sym;
+    mesh.heFace[edge] = state.face;
+    mesh.heVert[edge] = state.vert;
+}
+
+void MeshHistory::setFace(HalfEdgeMesh &mesh, uint32_t face, const FaceState &state) {
+    mesh.faceEdge[face] = state.edge;
+    mesh.faceColor[face] = state.color;
+}
+
+void MeshHistory::begin(const HalfEdgeMesh &mesh, int mergeId) {
+    recording = &mesh;
+    current = Edit();
+    current.mergeId = mergeId;
+    current.vertsBefore = mesh.numVerts();
+    current.halfEdgesBefore = mesh.numHalfEdges();
+    current.facesBefore = mesh.numFaces();
+}
+
+void MeshHistory::saveVertex(uint32_t vert) {
+    if (!recording || vert >= current.vertsBefore) return;
+    current.verts.push_back(vert);
+    current.vertStates.push_back(getVertex(*recording, vert));
+}
+
+void MeshHistory::saveHalfEdge(uint32_t edge) {
+    if (!recording || edge >= current.halfEdgesBefore) return;
+    current.halfEdges.push_back(edge);
+    current.halfEdgeStates.push_back(getHalfEdge(*recording, edge));
+}
+
+void MeshHistory::saveFace(uint32_t face) {
+    if (!recording || face >= current.facesBefore) return;
+    current.faces.push_back(face);
+    current.faceStates.push_back(getFace(*recording, face));
+}
+
+void MeshHistory::saveFaceLoop(uint32_t face) {
+    if (!recording || face >= current.facesBefore) return;
+    saveFace(face);
+    uint32_t edge = recording->faceEdge[face];
+    do {
+        saveHalfEdge(edge);
+        edge = recording->heNext[edge];
+    } while (edge != recording->faceEdge[face]);
+}
+
+void MeshHistory::saveRegion(const std::vector<uint32_t> &faces) {
+    if (!recording) return;
+    const HalfEdgeMesh &mesh = *recording;
+    for (uint32_t face : faces) {
+        if (face >= current.facesBefore) continue;
+        saveFaceLoop(face);
+        uint32_t edge = mesh.faceEdge[face];
+        do {
+            saveVertex(mesh.heVert[edge]);
+            if (mesh.heSym[edge] != NO_INDEX) saveFaceLoop(mesh.heFace[mesh.heSym[edge]]);
+            edge = mesh.heNext[edge];
+        } while (edge != mesh.faceEdge[face]);
+    }
+}
+
+void MeshHistory::saveAll() {
+    if (!recording) return;
+    const HalfEdgeMesh &mesh = *recording;
+    current.verts.resize(current.vertsBefore);
+    current.vertStates.resize(current.vertsBefore);
+    for (uint32_t v = 0; v < current.vertsBefore; v++) {
+        current.verts[v] = v;
+        current.vertStates[v] = getVertex(mesh, v);
+    }
+    current.halfEdges.resize(current.halfEdgesBefore);
+    current.halfEdgeStates.resize(current.halfEdgesBefore);
+    for (uint32_t e = 0; e < current.halfEdgesBefore; e++) {
+        current.halfEdges[e] = e;
+        current.halfEdgeStates[e] = getHalfEdge(mesh, e);
+    }
+    current.faces.resize(current.facesBefore);
+    current.faceStates.resize(current.facesBefore);
+    for (uint32_t f = 0; f < current.facesBefore; f++) {
+        current.faces[f] = f;
+        current.faceStates[f] = getFace(mesh, f);
+    }
+}
+
+void MeshHistory::end() {
+    if (!recording) return;
+    const HalfEdgeMesh &mesh = *recording;
+    recording = nullptr;
+
+    Edit edit = std::move(current);
+    current = Edit();
+    edit.vertsAfter = mesh.numVerts();
+    edit.halfEdgesAfter = mesh.numHalfEdges();
+    edit.facesAfter = mesh.numFaces();
+
+    keepChanged(edit.verts, edit.vertStates, [&](uint32_t v) { return getVertex(mesh, v); });
+    keepChanged(edit.halfEdges, edit.halfEdgeStates, [&](uint32_t e) { return getHalfEdge(mesh, e); });
+    keepChanged(edit.faces, edit.faceStates, [&](uint32_t f) { return getFace(mesh, f); });
+
+    const bool appended = edit.vertsAfter != edit.vertsBefore || edit.halfEdgesAfter != edit.halfEdgesBefore ||
+                          edit.facesAfter != edit.facesBefore;
+    if (!appended && edit.verts.empty() && edit.halfEdges.empty() && edit.faces.empty()) return;
+
+    for (const Edit &undone : redoStack) usedBytes -= undone.memoryUsage();
+    redoStack.clear();
+
+    // The last edit already holds the values from before this one
+    if (edit.mergeId != 0 && !appended && !undoStack.empty()) {
+        const Edit &last = undoStack.back();
+        bool lastAppended = last.vertsAfter != last.vertsBefore || last.halfEdgesAfter != last.halfEdgesBefore ||
+                            last.facesAfter != last.facesBefore;
+        if (last.mergeId == edit.mergeId && !lastAppended && last.verts == edit.verts &&
+            last.halfEdges == edit.halfEdges && last.faces == edit.faces) {
+            return;
+        }
+    }
+
+    usedBytes += edit.memoryUsage();
+    undoStack.push_back(std::move(edit));
+    trim();
+}
+
+void MeshHistory::swapSaved(HalfEdgeMesh &mesh, Edit &edit) {
+    bool onlyPositionsAndColors = edit.vertsAfter == edit.vertsBefore && edit.halfEdgesAfter == edit.halfEdgesBefore &&
+                                  edit.facesAfter == edit.facesBefore && edit.halfEdges.empty();
+    for (size_t i = 0; i < edit.verts.size(); i++) {
+        VertexState state = getVertex(mesh, edit.verts[i]);
+        const VertexState &saved = edit.vertStates[i];
+        onlyPositionsAndColors = onlyPositionsAndColors && state.edge == saved.edge &&
+                                 std::memcmp(&state.skin, &saved.skin, sizeof(SkinInfluences)) == 0;
+        setVertex(mesh, edit.verts[i], saved);
+        edit.vertStates[i] = state;
+    }
+    for (size_t i = 0; i < edit.halfEdges.size(); i++) {
+        HalfEdgeState state = getHalfEdge(mesh, edit.halfEdges[i]);
+        setHalfEdge(mesh, edit.halfEdges[i], edit.halfEdgeStates[i]);
+        edit.halfEdgeStates[i] = state;
+    }
+    for (size_t i = 0; i < edit.faces.size(); i++) {
+        FaceState state = getFace(mesh, edit.faces[i]);
+        onlyPositionsAndColors = onlyPositionsAndColors && state.edge == edit.faceStates[i].edge;
+        setFace(mesh, edit.faces[i], edit.faceStates[i]);
+        edit.faceStates[i] = state;
+    }
+
+    change.onlyPositionsAndColors = onlyPositionsAndColors;
+    change.verts.clear();
+    change.faces.clear();
+    if (onlyPositionsAndColors) {
+        change.verts = edit.verts;
+        change.faces = edit.faces;
+    }
+}
+
+void MeshHistory::resize(HalfEdgeMesh &mesh, uint32_t verts, uint32_t halfEdges, uint32_t faces) {
+    mesh.heNext.resize(halfEdges);
+    mesh.heSym.resize(halfEdges);
+    mesh.heFace.resize(halfEdges);
+    mesh.heVert.resize(halfEdges);
+    mesh.posX.resize(verts);
+    mesh.posY.resize(verts);
+    mesh.posZ.resize(verts);
+    mesh.vertEdge.resize(verts);
+    mesh.vertSkin.resize(verts);
+    mesh.faceEdge.resize(faces);
+    mesh.faceColor.resize(faces);
+}
+
+bool MeshHistory::undo(HalfEdgeMesh &mesh) {
+    if (undoStack.empty()) return false;
+    Edit edit = std::move(undoStack.back());
+    undoStack.pop_back();
+    usedBytes -= edit.memoryUsage();
+
+    // The appended elements move into the edit before the arrays are cut back
+    edit.addedVerts.resize(edit.vertsAfter - edit.vertsBefore);
+    for (uint32_t i = 0; i < edit.addedVerts.size(); i++) {
+        edit.addedVerts[i] = getVertex(mesh, edit.vertsBefore + i);
+    }
+    edit.addedHalfEdges.resize(edit.halfEdgesAfter - edit.halfEdgesBefore);
+    for (uint32_t i = 0; i < edit.addedHalfEdges.size(); i++) {
+        edit.addedHalfEdges[i] = getHalfEdge(mesh, edit.halfEdgesBefore + i);
+    }
+    edit.addedFaces.resize(edit.facesAfter - edit.facesBefore);
+    for (uint32_t i = 0; i < edit.addedFaces.size(); i++) {
+        edit.addedFaces[i] = getFace(mesh, edit.facesBefore + i);
+    }
+    resize(mesh, edit.vertsBefore, edit.halfEdgesBefore, edit.facesBefore);
+    swapSaved(mesh, edit);
+
+    usedBytes += edit.memoryUsage();
+    redoStack.push_back(std::move(edit));
+    trim();
+    return true;
+}
+
+bool MeshHistory::redo(HalfEdgeMesh &mesh) {
+    if (redoStack.empty()) return false;
+    Edit edit = std::move(redoStack.back());
+    redoStack.pop_back();
+    usedBytes -= edit.memoryUsage();
+
+    resize(mesh, edit.vertsAfter, edit.halfEdgesAfter, edit.facesAfter);
+    for (uint32_t i = 0; i < edit.addedVerts.size(); i++) {
+        setVertex(mesh, edit.vertsBefore + i, edit.addedVerts[i]);
+    }
+    for (uint32_t i = 0; i < edit.addedHalfEdges.size(); i++) {
+        setHalfEdge(mesh, edit.halfEdgesBefore + i, edit.addedHalfEdges[i]);
+    }
+    for (uint32_t i = 0; i < edit.addedFaces.size(); i++) {
+        setFace(mesh, edit.facesBefore + i, edit.addedFaces[i]);
+    }
+    std::vector<VertexState>().swap(edit.addedVerts);
+    std::vector<HalfEdgeState>().swap(edit.addedHalfEdges);
+    std::vector<FaceState>().swap(edit.addedFaces);
+    swapSaved(mesh, edit);
+
+    usedBytes += edit.memoryUsage();
+    undoStack.push_back(std::move(edit));
+    trim();
+    return true;
+}
+
+void MeshHistory::clear() {
+    recording = nullptr;
+    current = Edit();
+    undoStack.clear();
+    redoStack.clear();
+    usedBytes = 0;
+}
+
+void MeshHistory::trim() {
+    // The most recent edit is kept even if it alone is over the limit
+    while (usedBytes > memoryLimit && !undoStack.empty() && undoStack.size() + redoStack.size() > 1) {
+        usedBytes -= undoStack.front().memoryUsage();
+        undoStack.pop_front();
+    }
+}
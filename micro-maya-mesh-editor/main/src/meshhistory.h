@@ -0,0 +1,121 @@
+#ifndef MESHHISTORY_H
+#define MESHHISTORY_H
+
+#include "halfedgemesh.h"
+#include <deque>
+
+// Undo and redo of HalfEdgeMesh edits, each stored as a delta rather than as a copy of the mesh.
+// Edits may only overwrite existing elements and append new ones, so an edit is recorded as
+// the previous value of every existing element it changed plus the element counts before and
+// after it. Undoing swaps the saved values back in and truncates the arrays, which moves the
+// appended elements out into the edit for redo. Both directions cost the size of the edit.
+//
+// Recording an edit:
+//     history.begin(mesh);
+//     history.saveFaceLoop(face);   // every existing element the edit may change, before it does
+//     mesh.triangulate(face);
+//     history.end();
+class MeshHistory
+{
+public:
+    // At most this many bytes of edits are kept, the oldest ones are dropped first
+    explicit MeshHistory(size_t memoryLimit = 256u << 20);
+
+    // Start recording an edit of mesh. Edits with the same nonzero mergeId that change the
+    // same elements one after the other are merged into one, e.g. the steps of a spin box.
+    void begin(const HalfEdgeMesh &mesh, int mergeId = 0);
+    // Save the current value of an existing element
+    void saveVertex(uint32_t vert);
+    void saveHalfEdge(uint32_t edge);
+    void saveFace(uint32_t face);
+    // Save a Face and every HalfEdge on it
+    void saveFaceLoop(uint32_t face);
+    // Save the given Faces with their HalfEdges and vertices, and every Face sharing an edge with them
+    void saveRegion(const std::vector<uint32_t> &faces);
+    // Save every element, for edits that rewrite the whole mesh such as subdivision
+    void saveAll();
+    // Finish the edit. Saved elements that did not change are dropped, and an edit that
+    // changed nothing is not recorded at all. Any other edit clears the redo stack.
+    void end();
+
+    bool canUndo() const { return !undoStack.empty(); }
+    bool canRedo() const { return !redoStack.empty(); }
+    // Revert mesh to before the last edit, or apply the last undone one again.
+    // mesh must be in the state the history left it in. Returns false if there is nothing to do.
+    bool undo(HalfEdgeMesh &mesh);
+    bool redo(HalfEdgeMesh &mesh);
+
+    // What the last undo() or redo() changed. When it only moved vertices and recolored faces,
+    // verts and faces list them so that a display can update just those elements.
+    struct Change {
+        bool onlyPositionsAndColors;
+        std::vector<uint32_t> verts;
+        std::vector<uint32_t> faces;
+    };
+    const Change &lastChange() const { return change; }
+
+    // Forget every edit, e.g. when another mesh is loaded
+    void clear();
+
+    // Bytes held by the recorded edits
+    size_t memoryUsage() const { return usedBytes; }
+
+private:
+    struct VertexState {
+        float x, y, z;
+        uint32_t edge;
+        SkinInfluences skin;
+    };
+    struct HalfEdgeState {
+        uint32_t next, sym, face, vert;
+    };
+    struct FaceState {
+        uint32_t edge;
+        glm::vec3 color;
+    };
+
+    struct Edit {
+        int mergeId;
+        // Element counts before and after the edit
+        uint32_t vertsBefore, halfEdgesBefore, facesBefore;
+        uint32_t vertsAfter, halfEdgesAfter, facesAfter;
+        // Existing elements the edit changed, with their value on the other side of the edit
+        std::vector<uint32_t> verts;
+        std::vector<VertexState> vertStates;
+        std::vector<uint32_t> halfEdges;
+        std::vector<HalfEdgeState> halfEdgeStates;
+        std::vector<uint32_t> faces;
+        std::vector<FaceState> faceStates;
+        // Elements the edit appended, only held while it is undone
+        std::vector<VertexState> addedVerts;
+        std::vector<HalfEdgeState> addedHalfEdges;
+        std::vector<FaceState> addedFaces;
+
+        size_t memoryUsage() const;
+    };
+
+    static VertexState getVertex(const HalfEdgeMesh &mesh, uint32_t vert);
+    static HalfEdgeState getHalfEdge(const HalfEdgeMesh &mesh, uint32_t edge);
+    static FaceState getFace(const HalfEdgeMesh &mesh, uint32_t face);
+    static void setVertex(HalfEdgeMesh &mesh, uint32_t vert, const VertexState &state);
+    static void setHalfEdge(HalfEdgeMesh &mesh, uint32_t edge, const HalfEdgeState &state);
+    static void setFace(HalfEdgeMesh &mesh, uint32_t face, const FaceState &state);
+
+    // Exchange the saved values of edit with the mesh's, and describe the exchange in change
+    void swapSaved(HalfEdgeMesh &mesh, Edit &edit);
+    // Resize every array of mesh to the given counts
+    static void resize(HalfEdgeMesh &mesh, uint32_t verts, uint32_t halfEdges, uint32_t faces);
+    // Drop the oldest edits until the history fits in memoryLimit
+    void trim();
+
+    const HalfEdgeMesh *recording;
+    Edit current;
+
+    std::deque<Edit> undoStack;
+    std::deque<Edit> redoStack;
+    Change change;
+    size_t memoryLimit;
+    size_t usedBytes;
+};
+
+#endif // MESHHISTORY_H
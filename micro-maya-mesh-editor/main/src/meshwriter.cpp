@@ -0,0 +1,168 @@
+#include "meshwriter.h"
+#include "parallel.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Elements formatted into one buffer, and buffers formatted in parallel before being written
+const uint32_t BLOCK_SIZE = 16384;
+const uint32_t BLOCKS_PER_ROUND = 16;
+
+class Output
+{
+public:
+    explicit Output(const std::string &path) : file(fopen(path.c_str(), "wb")), ok(file != nullptr) {}
+    ~Output() { close(); }
+
+    bool isOpen() const { return file != nullptr; }
+
+    void write(const std::string &buffer) {
+        if (ok && !buffer.empty()) {
+            ok = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+        }
+    }
+
+    // Returns false if any write failed
+    bool close() {
+        if (file) {
+            ok = fclose(file) == 0 && ok;
+            file = nullptr;
+        }
+        return ok;
+    }
+
+    // Call format(i, buffer) for every i in [0, count), appending element i to buffer,
+    // and write the buffers in the order of i
+    template<typename Func>
+    void stream(uint32_t count, const Func &format) {
+        std::vector<std::string> buffers(BLOCKS_PER_ROUND);
+        const uint32_t numBlocks = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        for (uint32_t first = 0; first < numBlocks && ok; first += BLOCKS_PER_ROUND) {
+            uint32_t last = std::min(numBlocks, first + BLOCKS_PER_ROUND);
+            parallelFor(first, last, [&](uint32_t block) {
+                std::string &buffer = buffers[block - first];
+                buffer.clear();
+                uint32_t end = std::min(count, (block + 1) * BLOCK_SIZE);
+                for (uint32_t i = block * BLOCK_SIZE; i < end; i++) {
+                    format(i, buffer);
+                }
+            }, 1);
+            for (uint32_t block = first; block < last; block++) {
+                write(buffers[block - first]);
+            }
+        }
+    }
+
+private:
+    FILE *file;
+    bool ok;
+};
+
+inline void appendFloat(std::string &buffer, float value) {
+    char text[32];
+    char *end = std::to_chars(text, text + sizeof(text), value).ptr;
+    buffer.append(text, end);
+}
+
+inline void appendIndex(std::string &buffer, uint32_t value) {
+    char text[16];
+    char *end = std::to_chars(text, text + sizeof(text), value).ptr;
+    buffer.append(text, end);
+}
+
+template<typename T>
+inline void appendBinary(std::string &buffer, T value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline uint8_t toByte(float channel) {
+    return (uint8_t)(std::min(std::max(channel, 0.f), 1.f) * 255.f + 0.5f);
+}
+
+bool hasExtension(const std::string &path, const char *extension) {
+    size_t length = strlen(extension);
+    if (path.size() < length) return false;
+    for (size_t i = 0; i < length; i++) {
+        char c = path[path.size() - length + i];
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        if (c != extension[i]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool MeshWriter::save(const std::string &path, const HalfEdgeMesh &mesh, const HalfEdgeMesh *posed) {
+    if (hasExtension(path, ".obj")) return saveObj(path, mesh, posed);
+    if (hasExtension(path, ".ply")) return savePly(path, mesh, posed);
+    return false;
+}
+
+bool MeshWriter::saveObj(const std::string &path, const HalfEdgeMesh &mesh, const HalfEdgeMesh *posed) {
+    Output output(path);
+    if (!output.isOpen()) return false;
+    const HalfEdgeMesh &positions = posed ? *posed : mesh;
+
+    output.stream(mesh.numVerts(), [&](uint32_t v, std::string &buffer) {
+        buffer += "v ";
+        appendFloat(buffer, positions.posX[v]);
+        buffer += ' ';
+        appendFloat(buffer, positions.posY[v]);
+        buffer += ' ';
+        appendFloat(buffer, positions.posZ[v]);
+        buffer += '\n';
+    });
+    output.stream(mesh.numFaces(), [&](uint32_t f, std::string &buffer) {
+        buffer += 'f';
+        uint32_t edge = mesh.faceEdge[f];
+        do {
+            buffer += ' ';
+            appendIndex(buffer, mesh.heVert[edge] + 1);
+            edge = mesh.heNext[edge];
+        } while (edge != mesh.faceEdge[f]);
+        buffer += '\n';
+    });
+    return output.close();
+}
+
+bool MeshWriter::savePly(const std::string &path, const HalfEdgeMesh &mesh, const HalfEdgeMesh *posed) {
+    Output output(path);
+    if (!output.isOpen()) return false;
+    const HalfEdgeMesh &positions = posed ? *posed : mesh;
+
+    // Binary values are written in the byte order of this machine, which the header declares
+    const uint16_t one = 1;
+    const bool littleEndian = *reinterpret_cast<const uint8_t*>(&one) == 1;
+
+    std::string header = "ply\nformat ";
+    header += littleEndian ? "binary_little_endian" : "binary_big_endian";
+    header += " 1.0\nelement vertex ";
+    appendIndex(header, mesh.numVerts());
+    header += "\nproperty float x\nproperty float y\nproperty float z\nelement face ";
+    appendIndex(header, mesh.numFaces());
+    header += "\nproperty list int uint vertex_indices\n"
+              "property uchar red\nproperty uchar green\nproperty uchar blue\nend_header\n";
+    output.write(header);
+
+    output.stream(mesh.numVerts(), [&](uint32_t v, std::string &buffer) {
+        appendBinary(buffer, positions.posX[v]);
+        appendBinary(buffer, positions.posY[v]);
+        appendBinary(buffer, positions.posZ[v]);
+    });
+    output.stream(mesh.numFaces(), [&](uint32_t f, std::string &buffer) {
+        appendBinary<int32_t>(buffer, mesh.faceDegree(f));
+        uint32_t edge = mesh.faceEdge[f];
+        do {
+            appendBinary(buffer, mesh.heVert[edge]);
+            edge = mesh.heNext[edge];
+        } while (edge != mesh.faceEdge[f]);
+        const glm::vec3 &color = mesh.faceColor[f];
+        appendBinary(buffer, toByte(color.r));
+        appendBinary(buffer, toByte(color.g));
+        appendBinary(buffer, toByte(color.b));
+    });
+    return output.close();
+}
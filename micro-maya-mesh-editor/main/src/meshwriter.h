@@ -0,0 +1,26 @@
+#ifndef MESHWRITER_H
+#define MESHWRITER_H
+
+#include "halfedgemesh.h"
+#include <string>
+
+// Writes a HalfEdgeMesh as a Wavefront .obj or a binary little- or big-endian .ply file.
+// Elements are formatted in blocks, several blocks at once over threads, into buffers that are
+// then written in order with one large fwrite each. Floats are printed with std::to_chars, the
+// shortest text that reads back to the same value, without going through the C locale.
+class MeshWriter
+{
+public:
+    // Write mesh to path, in the format given by its extension, .obj or .ply.
+    // If posed is given, e.g. the output of Skinning::skin, its positions are written instead of mesh's.
+    // Returns false if the extension is unknown or the file cannot be written.
+    static bool save(const std::string &path, const HalfEdgeMesh &mesh, const HalfEdgeMesh *posed = nullptr);
+
+    // "v" and "f" lines, with 1-based indices, in the same order as the mesh's arrays
+    static bool saveObj(const std::string &path, const HalfEdgeMesh &mesh, const HalfEdgeMesh *posed = nullptr);
+
+    // float x, y, z per vertex, and per face its vertex indices and its color as uchar red, green, blue
+    static bool savePly(const std::string &path, const HalfEdgeMesh &mesh, const HalfEdgeMesh *posed = nullptr);
+};
+
+#endif // MESHWRITER_H
@@ -1,41 +1,112 @@
 #include "mygl.h"
 #include <la.h>
+#include "decimation.h"
+#include "meshwriter.h"
+#include "objloader.h"
+#include "skinning.h"
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <QApplication>
 #include <QKeyEvent>
+#include <QMouseEvent>
 #include <QFileDialog>
 #include <QFile>
-#include <QTextStream>
+#include <QDebug>
+#include <QThread>
 #include <QJsonDocument>
 #include <random>
 
+// Rate at which clips are played back and their poses cached
+static const int ANIMATION_FPS = 60;
+
+// Merge ids of the edits made one spin box step at a time
+static const int MERGE_POSITION = 1;
+static const int MERGE_COLOR = 2;
+
 MyGL::MyGL(QWidget *parent) :
     OpenGLContext(parent),
     m_geomSquare(this),
     m_progLambert(this),
     m_progFlat(this),
     m_progSkeleton(this),
+    m_progSkeletonDq(this),
+    m_progGizmo(this),
     m_glCamera(),
+    m_palette(),
+    m_dualQuats(),
+    m_jointPalette(this),
+    m_jointGizmos(this),
+    m_instancedGizmos(true),
     m_loadedMesh(this),
     m_loadedSkeleton(this),
-    m_chosenVertex(nullptr),
-    m_chosenHalfEdge(nullptr),
-    m_chosenFace(nullptr),
+    m_posedMesh(this),
+    m_cpuSkinning(false),
+    m_exportPosed(false),
+    m_history(),
+    m_chosenVertex(NO_INDEX),
+    m_chosenHalfEdge(NO_INDEX),
+    m_chosenFace(NO_INDEX),
     m_vertDisplay(this),
     m_halfEdgeDisplay(this),
-    m_faceDisplay(this)
+    m_faceDisplay(this),
+    m_subdivisionLevels(1),
+    m_bindInfluences(2),
+    m_faceBvh(),
+    m_bvhNeedsBuild(true),
+    m_bvhNeedsRefit(false),
+    m_pickMesh(),
+    m_lodMesh(this),
+    m_lodEnabled(false),
+    m_lodNeedsBuild(true),
+    m_lodTriangles(5000),
+    m_lodThread(nullptr),
+    m_lodGeneration(0),
+    m_lodTimer(),
+    m_cameraMoving(false),
+    m_idleTimer(),
+    m_clip(),
+    m_animationTimer(),
+    m_animationClock(),
+    m_cachePoses(false)
 {
     setFocusPolicy(Qt::StrongFocus);
+
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(300);
+    connect(&m_idleTimer, &QTimer::timeout, [this]() {
+        m_cameraMoving = false;
+        update();
+    });
+
+    m_lodTimer.setSingleShot(true);
+    m_lodTimer.setInterval(500);
+    connect(&m_lodTimer, &QTimer::timeout, this, &MyGL::updateLod);
+
+    m_animationTimer.setTimerType(Qt::PreciseTimer);
+    m_animationTimer.setInterval(1000 / ANIMATION_FPS);
+    connect(&m_animationTimer, &QTimer::timeout, [this]() {
+        m_clip.sample(m_animationClock.elapsed() * 0.001f, m_loadedSkeleton.hierarchy);
+        updateSkeletonDisplay();
+        updatePose();
+        update();
+    });
 }
 
 MyGL::~MyGL()
 {
+    if (m_lodThread) m_lodThread->wait();
     makeCurrent();
     glDeleteVertexArrays(1, &vao);
     m_geomSquare.destroy();
     m_loadedMesh.destroy();
+    m_posedMesh.destroy();
+    m_lodMesh.destroy();
     m_loadedSkeleton.destroy();
+    m_jointGizmos.destroy();
+    m_jointGizmos.destroyInstances();
+    m_jointPalette.destroy();
     m_vertDisplay.destroy();
     m_halfEdgeDisplay.destroy();
     m_faceDisplay.destroy();
@@ -80,6 +151,15 @@ void MyGL::initializeGL()
     m_progFlat.create(":/glsl/flat.vert.glsl", ":/glsl/flat.frag.glsl");
     // Create and set up the skeleton rendering shader
     m_progSkeleton.create(":/glsl/skeleton.vert.glsl", ":/glsl/skeleton.frag.glsl");
+    m_progSkeleton.setPaletteUnit(0);
+    m_progSkeletonDq.create(":/glsl/skeleton_dq.vert.glsl", ":/glsl/skeleton.frag.glsl");
+    m_progSkeletonDq.setPaletteUnit(0);
+    // Create and set up the instanced joint gizmo shader
+    m_progGizmo.create(":/glsl/gizmo.vert.glsl", ":/glsl/flat.frag.glsl");
+    m_progGizmo.setInstanceUnit(1);
+    m_jointGizmos.create();
+    // Create the texture buffer the skeleton shader reads joint matrices from
+    m_jointPalette.create();
     // We have to have a VAO bound in OpenGL 3.2 Core. But if we're not
     // using multiple VAOs, we can just bind one once.
     glBindVertexArray(vao);
@@ -99,6 +179,7 @@ void MyGL::resizeGL(int w, int h)
     m_progLambert.setViewProjMatrix(viewproj);
     m_progFlat.setViewProjMatrix(viewproj);
     m_progSkeleton.setViewProjMatrix(viewproj);
+    m_progSkeletonDq.setViewProjMatrix(viewproj);
 
     printGLErrorLog();
 }
@@ -119,19 +200,36 @@ void MyGL::paintGL()
 
     m_progSkeleton.setViewProjMatrix(m_glCamera.getViewProj());
     m_progSkeleton.setModelMatrix(glm::mat4(1.f));
+    m_progSkeletonDq.setViewProjMatrix(m_glCamera.getViewProj());
+    m_progSkeletonDq.setModelMatrix(glm::mat4(1.f));
+
+    m_progGizmo.setViewProjMatrix(m_glCamera.getViewProj());
 
-    if (m_loadedMesh.verts.empty() || m_loadedMesh.verts[0]->joints.empty()) {
-        m_progLambert.draw(m_loadedMesh);
+    if (m_loadedMesh.numVerts() == 0 || m_loadedMesh.vertSkin[0].empty()) {
+        bool drawLod = m_lodEnabled && m_cameraMoving && !m_lodNeedsBuild && m_lodMesh.numFaces() > 0;
+        m_progLambert.draw(drawLod ? m_lodMesh : m_loadedMesh);
+    } else if (m_cpuSkinning) {
+        m_progLambert.draw(m_posedMesh);
     } else {
-        m_progSkeleton.draw(m_loadedMesh);
+        m_jointPalette.bind(0);
+        if (m_loadedMesh.skinningMethod == DUAL_QUATERNION) {
+            m_progSkeletonDq.draw(m_loadedMesh);
+        } else {
+            m_progSkeleton.draw(m_loadedMesh);
+        }
     }
 
     glDisable(GL_DEPTH_TEST);
 
-    if (m_chosenVertex) m_progFlat.draw(m_vertDisplay);
-    if (m_chosenHalfEdge) m_progFlat.draw(m_halfEdgeDisplay);
-    if (m_chosenFace) m_progFlat.draw(m_faceDisplay);
-    m_progFlat.draw(m_loadedSkeleton);
+    if (m_chosenVertex != NO_INDEX) m_progFlat.draw(m_vertDisplay);
+    if (m_chosenHalfEdge != NO_INDEX) m_progFlat.draw(m_halfEdgeDisplay);
+    if (m_chosenFace != NO_INDEX) m_progFlat.draw(m_faceDisplay);
+    if (!m_instancedGizmos) {
+        m_progFlat.draw(m_loadedSkeleton);
+    } else if (m_jointGizmos.instanceCount() > 0) {
+        m_jointGizmos.bindInstances(1);
+        m_progGizmo.draw(m_jointGizmos, m_jointGizmos.instanceCount());
+    }
 
     glEnable(GL_DEPTH_TEST);
 }
@@ -140,128 +238,49 @@ void MyGL::slot_loadMesh() {
     QString fileName = QFileDialog::getOpenFileName(nullptr,
                                                    tr("Load .obj"), "../obj_files", tr(".obj Files (*.obj)"));
     if (!fileName.isNull()) {
-        QFile file(fileName);
-        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (!ObjLoader::load(fileName.toStdString(), m_loadedMesh)) {
+            qWarning() << "Could not load" << fileName;
+        }
 
-            m_loadedMesh.verts.clear();
-            m_loadedMesh.edges.clear();
-            m_loadedMesh.faces.clear();
-
-            Vertex::lastVertexId = 0;
-            Face::lastFaceId = 0;
-            HalfEdge::lastEdgeId = 0;
-
-            // Examples
-            // v 2.229345 -0.992723 -0.862826 vertex
-            // vt 0.048321 0.967508 texture
-            // vn -0.410409 0.393346 -0.822705 normal
-            // f 947/644/5398 967/670/5399 948/614/5400 vertex/texture/normal
-
-            std::vector<glm::vec3> vertices;
-            std::vector<glm::vec2> textures;
-            std::vector<glm::vec3> normals;
-            // For sym, <vertIdx, vertIdx> -> HE
-            std::map<std::pair<int, int>, HalfEdge*> edgeMap;
-
-            QTextStream in(&file);
-
-            while (!in.atEnd()) {
-                QString line = in.readLine();
-                QTextStream lineStream(&line);
-                QString type;
-
-                lineStream >> type;
-
-                if (type == "v") {
-                    glm::vec3 vert;
-                    lineStream >> vert.x >> vert.y >> vert.z;
-                    vertices.push_back(vert);
-
-                    uPtr<Vertex> p_vert = mkU<Vertex>();
-                    p_vert->pos = vert;
-                    m_loadedMesh.verts.push_back(std::move(p_vert));
-
-                } else if (type == "vt") {
-                    glm::vec2 text;
-                    lineStream >> text.x >> text.y;
-                    textures.push_back(text);
-
-                } else if (type == "vn") {
-                    glm::vec3 norm;
-                    lineStream >> norm.x >> norm.y >> norm.z;
-                    normals.push_back(norm);
-
-                } else if (type == "f") {
-                    uPtr<Face> p_face = mkU<Face>();
-                    p_face->color = Mesh::getRandomColor();
-
-                    QStringList vertIndices = line.split(' ');
-                    // -1 because of the initial "f"
-                    int numVerts = vertIndices.size() - 1;
-
-                    HalfEdge* prevEdge = nullptr;
-                    HalfEdge* firstEdge = nullptr;
-
-                    for (int i = 1; i <= numVerts; i++) {
-                        int vertIdx = vertIndices[i].split('/')[0].toInt() - 1;
-                        int prevIdx = i != 1 ?
-                                      vertIndices[i - 1].split('/')[0].toInt() - 1:
-                                      vertIndices[numVerts].split('/')[0].toInt() - 1;
-
-                        uPtr<HalfEdge> p_edge = mkU<HalfEdge>();
-                        p_edge->face = p_face.get();
-                        p_edge->vert = m_loadedMesh.verts[vertIdx].get();
-                        m_loadedMesh.verts[vertIdx]->edge = p_edge.get();
-                        p_face->edge = p_edge.get();
-
-                        if (prevEdge) {
-                            prevEdge->next = p_edge.get();
-                        } else {
-                            firstEdge = p_edge.get();
-                        }
-
-                        // Add to the map or set the sym pointer
-                        auto curEdge = std::make_pair(vertIdx, prevIdx);
-                        auto symEdge = std::make_pair(prevIdx, vertIdx);
-
-                        if (edgeMap.find(symEdge) != edgeMap.end()) {
-                            p_edge->sym = edgeMap[symEdge];
-                            edgeMap[symEdge]->sym = p_edge.get();
-                        } else {
-                            edgeMap[curEdge] = p_edge.get();
-                        }
-
-                        prevEdge = p_edge.get();
-
-                        m_loadedMesh.edges.push_back(std::move(p_edge));
-
-                        // If it's the last vertex of the face, close the loop
-                        if (i == numVerts) {
-                            prevEdge->next = firstEdge;
-                        }
-
-                    }
-
-                    p_face->edge = firstEdge;
-                    m_loadedMesh.faces.push_back(std::move(p_face));
-                }
-            }
+        m_history.clear();
+        m_chosenVertex = NO_INDEX;
+        m_chosenHalfEdge = NO_INDEX;
+        m_chosenFace = NO_INDEX;
 
-            m_chosenVertex = nullptr;
-            m_chosenHalfEdge = nullptr;
-            m_chosenFace = nullptr;
+        m_loadedMesh.destroy();
+        m_loadedMesh.create();
+        m_bvhNeedsBuild = true;
+        invalidateLod();
+        update();
 
-            m_loadedMesh.destroy();
-            m_loadedMesh.create();
-            update();
+        emit sig_buildComponentList(&m_loadedMesh);
+    }
+}
 
-            emit sig_buildComponentList(&m_loadedMesh);
+void MyGL::slot_exportMesh() {
+    if (m_loadedMesh.numFaces() == 0) return;
+    QString fileName = QFileDialog::getSaveFileName(nullptr,
+                                                    tr("Export Mesh"), "../obj_files", tr("Meshes (*.obj *.ply)"));
+    if (fileName.isNull()) return;
+    if (!fileName.endsWith(".obj", Qt::CaseInsensitive) && !fileName.endsWith(".ply", Qt::CaseInsensitive)) {
+        fileName += ".obj";
+    }
 
-            file.close();
-        }
+    HalfEdgeMesh posed;
+    bool writePosed = m_exportPosed && m_loadedSkeleton.hierarchy.size() > 0 && !m_loadedMesh.vertSkin[0].empty();
+    if (writePosed) {
+        posed = m_loadedMesh;
+        Skinning::pose(m_loadedMesh, m_loadedSkeleton.getTransformations(), m_loadedSkeleton.hierarchy.bind, posed);
+    }
+    if (!MeshWriter::save(fileName.toStdString(), m_loadedMesh, writePosed ? &posed : nullptr)) {
+        qWarning() << "Could not write" << fileName;
     }
 }
 
+void MyGL::slot_setExportPosed(bool posed) {
+    m_exportPosed = posed;
+}
+
 void MyGL::slot_loadSkeleton() {
     QString fileName = QFileDialog::getOpenFileName(nullptr,
                                                     tr("Load .json"), "../jsons", tr(".json Files (*.json)"));
@@ -269,12 +288,9 @@ void MyGL::slot_loadSkeleton() {
         QFile file(fileName);
         if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
             // Cleaning last skeleton and affliations
-            for (auto &vert : m_loadedMesh.verts) {
-                vert->joints.clear();
-            }
-            Joint::lastJointId = 0;
-            m_loadedSkeleton.chosenJoint = nullptr;
-            m_loadedSkeleton.joints.clear();
+            std::fill(m_loadedMesh.vertSkin.begin(), m_loadedMesh.vertSkin.end(), SkinInfluences());
+            m_loadedSkeleton.clear();
+            m_clip.clear();
 
             // Parse JSON file
             QByteArray data = file.readAll();
@@ -288,57 +304,32 @@ void MyGL::slot_loadSkeleton() {
     }
 
     emit sig_buildJointList(&m_loadedSkeleton);
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
+    updateSkeletonDisplay();
+    updatePose();
     update();
 }
 
 void MyGL::slot_bindMesh() {
     if (m_loadedSkeleton.joints.empty()) return;
 
-    std::vector<glm::mat4> transformations;
-    std::vector<glm::mat4> bindMatrices;
-
-    // Reserve space for performance
-    transformations.reserve(m_loadedSkeleton.joints.size());
-    bindMatrices.reserve(m_loadedSkeleton.joints.size());
-
-    for (const auto& joint : m_loadedSkeleton.joints) {
-        glm::mat4 transformation = joint->getOverallTransformation();
-        joint->bind = glm::inverse(transformation);
-        transformations.push_back(transformation);
-        bindMatrices.push_back(joint->bind);
-    }
-
-    for (auto& vert : m_loadedMesh.verts) {
-        // Pair of index and distance
-        std::pair<int, float> nearest[2] = {{-1, FLT_MAX}, {-1, FLT_MAX}};
-
-        for (int i = 0; i < static_cast<int>(transformations.size()); ++i) {
-            float dist = glm::distance2(glm::vec4(vert->pos, 1.0f), transformations[i] * glm::vec4(0, 0, 0, 1));
+    JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
+    hierarchy.bindPose();
+    const std::vector<glm::mat4> &transformations = hierarchy.getTransformations();
 
-            if (dist < nearest[0].second) {
-                nearest[1] = nearest[0]; // Replace the second nearest
-                nearest[0] = {i, dist}; // Set new nearest
-            } else if (dist < nearest[1].second) {
-                nearest[1] = {i, dist};
-            }
-        }
-
-        float weightSum = nearest[0].second + nearest[1].second;
-        vert->joints.clear(); // Ensure no previous bindings remain
-        vert->joints.push_back({nearest[0].first, 1.0f - nearest[0].second / weightSum});
-        vert->joints.push_back({nearest[1].first, 1.0f - nearest[1].second / weightSum});
+    std::vector<glm::vec3> jointPos;
+    jointPos.reserve(transformations.size());
+    for (const glm::mat4 &transformation : transformations) {
+        jointPos.push_back(glm::vec3(transformation[3]));
     }
-
-    // Pass to shader
-    m_progSkeleton.setTransformationMatrices(transformations);
-    m_progSkeleton.setBindMatrices(bindMatrices);
+    m_history.begin(m_loadedMesh);
+    m_history.saveAll();
+    m_loadedMesh.bindNearestJoints(jointPos, m_bindInfluences);
+    m_history.end();
 
     m_loadedMesh.destroy();
     m_loadedMesh.create();
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
+    updateSkeletonDisplay();
+    updatePose();
 
     update();
 }
@@ -350,270 +341,649 @@ QVector3D extractFromQuat(glm::quat q) {
     return QVector3D(roll, pitch, yaw);
 }
 
-void MyGL::slot_setChosenVertex(QListWidgetItem* vert) {
-    if (!vert) return;
-    m_chosenVertex = dynamic_cast<Vertex*>(vert);
+void MyGL::slot_setChosenVertex(const QModelIndex& vert) {
+    if (!vert.isValid()) return;
+    m_chosenVertex = vert.row();
     m_vertDisplay.destroy();
-    m_vertDisplay.updateVertex(m_chosenVertex);
+    m_vertDisplay.updateVertex(&m_loadedMesh, m_chosenVertex);
     m_vertDisplay.create();
 
-    emit sig_updatePosition(QVector3D(m_chosenVertex->pos.x, m_chosenVertex->pos.y, m_chosenVertex->pos.z));
+    glm::vec3 pos = m_loadedMesh.position(m_chosenVertex);
+    emit sig_updatePosition(QVector3D(pos.x, pos.y, pos.z));
     update();
 }
 
-void MyGL::slot_setChosenHalfEdge(QListWidgetItem* edge) {
-    if (!edge) return;
-    m_chosenHalfEdge = dynamic_cast<HalfEdge*>(edge);
+void MyGL::slot_setChosenHalfEdge(const QModelIndex& edge) {
+    if (!edge.isValid()) return;
+    m_chosenHalfEdge = edge.row();
     m_halfEdgeDisplay.destroy();
-    m_halfEdgeDisplay.updateHalfEdge(m_chosenHalfEdge);
+    m_halfEdgeDisplay.updateHalfEdge(&m_loadedMesh, m_chosenHalfEdge);
     m_halfEdgeDisplay.create();
     update();
 }
 
-void MyGL::slot_setChosenFace(QListWidgetItem* face) {
-    if (!face) return;
-    m_chosenFace = dynamic_cast<Face*>(face);
+void MyGL::slot_setChosenFace(const QModelIndex& face) {
+    if (!face.isValid()) return;
+    m_chosenFace = face.row();
     m_faceDisplay.destroy();
-    m_faceDisplay.updateFace(m_chosenFace);
+    m_faceDisplay.updateFace(&m_loadedMesh, m_chosenFace);
     m_faceDisplay.create();
 
-    emit sig_updateColor(QColor::fromRgbF(m_chosenFace->color.r, m_chosenFace->color.g, m_chosenFace->color.b));
+    const glm::vec3 &color = m_loadedMesh.faceColor[m_chosenFace];
+    emit sig_updateColor(QColor::fromRgbF(color.r, color.g, color.b));
     update();
 }
 
 void MyGL::slot_setChosenJoint(QTreeWidgetItem* joint) {
-    if (!joint) return;
-    m_loadedSkeleton.chosenJoint = dynamic_cast<Joint*>(joint);
+    Joint *item = dynamic_cast<Joint*>(joint);
+    if (!item) return;
+    m_loadedSkeleton.chosenJoint = item->id;
+    const JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
 
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
+    updateSkeletonDisplay();
 
-    emit sig_updateJointPos(QVector3D(m_loadedSkeleton.chosenJoint->pos.x,
-                                      m_loadedSkeleton.chosenJoint->pos.y,
-                                      m_loadedSkeleton.chosenJoint->pos.z));
-    emit sig_updateRotation(extractFromQuat(m_loadedSkeleton.chosenJoint->rot));
+    const glm::vec3 &pos = hierarchy.pos[m_loadedSkeleton.chosenJoint];
+    emit sig_updateJointPos(QVector3D(pos.x, pos.y, pos.z));
+    emit sig_updateRotation(extractFromQuat(hierarchy.rot[m_loadedSkeleton.chosenJoint]));
 
     update();
 }
 
 void MyGL::slot_setPositionX(double val) {
-    if (!m_chosenVertex) return;
-    m_chosenVertex->pos.x = val;
-    m_loadedMesh.destroy();
+    if (m_chosenVertex == NO_INDEX) return;
+    m_history.begin(m_loadedMesh, MERGE_POSITION);
+    m_history.saveVertex(m_chosenVertex);
+    m_loadedMesh.posX[m_chosenVertex] = val;
+    m_history.end();
+    m_bvhNeedsRefit = true;
+    invalidateLod();
+    m_loadedMesh.markVertexDirty(m_chosenVertex);
+    m_loadedMesh.updateDirty();
+    updatePoseDirty({m_chosenVertex}, {});
     m_vertDisplay.destroy();
-    m_loadedMesh.create();
     m_vertDisplay.create();
     update();
 }
 
 void MyGL::slot_setPositionY(double val) {
-    if (!m_chosenVertex) return;
-    m_chosenVertex->pos.y = val;
-    m_loadedMesh.destroy();
+    if (m_chosenVertex == NO_INDEX) return;
+    m_history.begin(m_loadedMesh, MERGE_POSITION);
+    m_history.saveVertex(m_chosenVertex);
+    m_loadedMesh.posY[m_chosenVertex] = val;
+    m_history.end();
+    m_bvhNeedsRefit = true;
+    invalidateLod();
+    m_loadedMesh.markVertexDirty(m_chosenVertex);
+    m_loadedMesh.updateDirty();
+    updatePoseDirty({m_chosenVertex}, {});
     m_vertDisplay.destroy();
-    m_loadedMesh.create();
     m_vertDisplay.create();
     update();
 }
 
 void MyGL::slot_setPositionZ(double val) {
-    if (!m_chosenVertex) return;
-    m_chosenVertex->pos.z = val;
-    m_loadedMesh.destroy();
+    if (m_chosenVertex == NO_INDEX) return;
+    m_history.begin(m_loadedMesh, MERGE_POSITION);
+    m_history.saveVertex(m_chosenVertex);
+    m_loadedMesh.posZ[m_chosenVertex] = val;
+    m_history.end();
+    m_bvhNeedsRefit = true;
+    invalidateLod();
+    m_loadedMesh.markVertexDirty(m_chosenVertex);
+    m_loadedMesh.updateDirty();
+    updatePoseDirty({m_chosenVertex}, {});
     m_vertDisplay.destroy();
-    m_loadedMesh.create();
     m_vertDisplay.create();
     update();
 }
 
 void MyGL::slot_setJointPosX(double val) {
-    if (!m_loadedSkeleton.chosenJoint) return;
-    m_loadedSkeleton.chosenJoint->pos.x = val;
-    m_progSkeleton.setTransformationMatrices(m_loadedSkeleton.getTransformations());
-    emit sig_updateRotation(extractFromQuat(m_loadedSkeleton.chosenJoint->rot));
-
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
-    m_loadedMesh.destroy();
-    m_loadedMesh.create();
+    if (m_loadedSkeleton.chosenJoint < 0) return;
+    JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
+    int joint = m_loadedSkeleton.chosenJoint;
+    glm::vec3 pos = hierarchy.pos[joint];
+    pos.x = val;
+    hierarchy.setPosition(joint, pos);
+    emit sig_updateRotation(extractFromQuat(hierarchy.rot[joint]));
+
+    updateSkeletonDisplay();
+    updatePose();
     update();
 }
 
 void MyGL::slot_setJointPosY(double val) {
-    if (!m_loadedSkeleton.chosenJoint) return;
-    m_loadedSkeleton.chosenJoint->pos.y = val;
-    m_progSkeleton.setTransformationMatrices(m_loadedSkeleton.getTransformations());
-    emit sig_updateRotation(extractFromQuat(m_loadedSkeleton.chosenJoint->rot));
-
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
-    m_loadedMesh.destroy();
-    m_loadedMesh.create();
+    if (m_loadedSkeleton.chosenJoint < 0) return;
+    JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
+    int joint = m_loadedSkeleton.chosenJoint;
+    glm::vec3 pos = hierarchy.pos[joint];
+    pos.y = val;
+    hierarchy.setPosition(joint, pos);
+    emit sig_updateRotation(extractFromQuat(hierarchy.rot[joint]));
+
+    updateSkeletonDisplay();
+    updatePose();
     update();
 }
 
 void MyGL::slot_setJointPosZ(double val) {
-    if (!m_loadedSkeleton.chosenJoint) return;
-    m_loadedSkeleton.chosenJoint->pos.z = val;
-    m_progSkeleton.setTransformationMatrices(m_loadedSkeleton.getTransformations());
-    emit sig_updateRotation(extractFromQuat(m_loadedSkeleton.chosenJoint->rot));
-
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
-    m_loadedMesh.destroy();
-    m_loadedMesh.create();
+    if (m_loadedSkeleton.chosenJoint < 0) return;
+    JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
+    int joint = m_loadedSkeleton.chosenJoint;
+    glm::vec3 pos = hierarchy.pos[joint];
+    pos.z = val;
+    hierarchy.setPosition(joint, pos);
+    emit sig_updateRotation(extractFromQuat(hierarchy.rot[joint]));
+
+    updateSkeletonDisplay();
+    updatePose();
     update();
 }
 
 void MyGL::slot_setJointRotXP() {
-    if (!m_loadedSkeleton.chosenJoint) return;
-    m_loadedSkeleton.chosenJoint->rot *= glm::rotate(glm::quat(), glm::radians(5.f), glm::vec3(1, 0, 0));
-    m_progSkeleton.setTransformationMatrices(m_loadedSkeleton.getTransformations());
-    emit sig_updateRotation(extractFromQuat(m_loadedSkeleton.chosenJoint->rot));
-
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
-    m_loadedMesh.destroy();
-    m_loadedMesh.create();
+    if (m_loadedSkeleton.chosenJoint < 0) return;
+    JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
+    int joint = m_loadedSkeleton.chosenJoint;
+    hierarchy.setRotation(joint, hierarchy.rot[joint] * glm::rotate(glm::quat(), glm::radians(5.f), glm::vec3(1, 0, 0)));
+    emit sig_updateRotation(extractFromQuat(hierarchy.rot[joint]));
+
+    updateSkeletonDisplay();
+    updatePose();
     update();
 }
 
 void MyGL::slot_setJointRotYP() {
-    if (!m_loadedSkeleton.chosenJoint) return;
-    m_loadedSkeleton.chosenJoint->rot *= glm::rotate(glm::quat(), glm::radians(5.f), glm::vec3(0, 1, 0));
-    m_progSkeleton.setTransformationMatrices(m_loadedSkeleton.getTransformations());
-    emit sig_updateRotation(extractFromQuat(m_loadedSkeleton.chosenJoint->rot));
-
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
-    m_loadedMesh.destroy();
-    m_loadedMesh.create();
+    if (m_loadedSkeleton.chosenJoint < 0) return;
+    JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
+    int joint = m_loadedSkeleton.chosenJoint;
+    hierarchy.setRotation(joint, hierarchy.rot[joint] * glm::rotate(glm::quat(), glm::radians(5.f), glm::vec3(0, 1, 0)));
+    emit sig_updateRotation(extractFromQuat(hierarchy.rot[joint]));
+
+    updateSkeletonDisplay();
+    updatePose();
     update();
 }
 
 void MyGL::slot_setJointRotZP() {
-    if (!m_loadedSkeleton.chosenJoint) return;
-    m_loadedSkeleton.chosenJoint->rot *= glm::rotate(glm::quat(), glm::radians(5.f), glm::vec3(0, 0, 1));
-    m_progSkeleton.setTransformationMatrices(m_loadedSkeleton.getTransformations());
-    emit sig_updateRotation(extractFromQuat(m_loadedSkeleton.chosenJoint->rot));
-
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
-    m_loadedMesh.destroy();
-    m_loadedMesh.create();
+    if (m_loadedSkeleton.chosenJoint < 0) return;
+    JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
+    int joint = m_loadedSkeleton.chosenJoint;
+    hierarchy.setRotation(joint, hierarchy.rot[joint] * glm::rotate(glm::quat(), glm::radians(5.f), glm::vec3(0, 0, 1)));
+    emit sig_updateRotation(extractFromQuat(hierarchy.rot[joint]));
+
+    updateSkeletonDisplay();
+    updatePose();
     update();
 }
 
 void MyGL::slot_setJointRotXM() {
-    if (!m_loadedSkeleton.chosenJoint) return;
-    m_loadedSkeleton.chosenJoint->rot *= glm::rotate(glm::quat(), glm::radians(-5.f), glm::vec3(1, 0, 0));
-    m_progSkeleton.setTransformationMatrices(m_loadedSkeleton.getTransformations());
-    emit sig_updateRotation(extractFromQuat(m_loadedSkeleton.chosenJoint->rot));
-
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
-    m_loadedMesh.destroy();
-    m_loadedMesh.create();
+    if (m_loadedSkeleton.chosenJoint < 0) return;
+    JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
+    int joint = m_loadedSkeleton.chosenJoint;
+    hierarchy.setRotation(joint, hierarchy.rot[joint] * glm::rotate(glm::quat(), glm::radians(-5.f), glm::vec3(1, 0, 0)));
+    emit sig_updateRotation(extractFromQuat(hierarchy.rot[joint]));
+
+    updateSkeletonDisplay();
+    updatePose();
     update();
 }
 
 void MyGL::slot_setJointRotYM() {
-    if (!m_loadedSkeleton.chosenJoint) return;
-    m_loadedSkeleton.chosenJoint->rot *= glm::rotate(glm::quat(), glm::radians(-5.f), glm::vec3(0, 1, 0));
-    m_progSkeleton.setTransformationMatrices(m_loadedSkeleton.getTransformations());
-    emit sig_updateRotation(extractFromQuat(m_loadedSkeleton.chosenJoint->rot));
-
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
-    m_loadedMesh.destroy();
-    m_loadedMesh.create();
+    if (m_loadedSkeleton.chosenJoint < 0) return;
+    JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
+    int joint = m_loadedSkeleton.chosenJoint;
+    hierarchy.setRotation(joint, hierarchy.rot[joint] * glm::rotate(glm::quat(), glm::radians(-5.f), glm::vec3(0, 1, 0)));
+    emit sig_updateRotation(extractFromQuat(hierarchy.rot[joint]));
+
+    updateSkeletonDisplay();
+    updatePose();
     update();
 }
 
 void MyGL::slot_setJointRotZM() {
-    if (!m_loadedSkeleton.chosenJoint) return;
-    m_loadedSkeleton.chosenJoint->rot *= glm::rotate(glm::quat(), glm::radians(-5.f), glm::vec3(0, 0, 1));
-    m_progSkeleton.setTransformationMatrices(m_loadedSkeleton.getTransformations());
-    emit sig_updateRotation(extractFromQuat(m_loadedSkeleton.chosenJoint->rot));
-
-    m_loadedSkeleton.destroy();
-    m_loadedSkeleton.create();
-    m_loadedMesh.destroy();
-    m_loadedMesh.create();
+    if (m_loadedSkeleton.chosenJoint < 0) return;
+    JointHierarchy &hierarchy = m_loadedSkeleton.hierarchy;
+    int joint = m_loadedSkeleton.chosenJoint;
+    hierarchy.setRotation(joint, hierarchy.rot[joint] * glm::rotate(glm::quat(), glm::radians(-5.f), glm::vec3(0, 0, 1)));
+    emit sig_updateRotation(extractFromQuat(hierarchy.rot[joint]));
+
+    updateSkeletonDisplay();
+    updatePose();
     update();
 }
 
 void MyGL::slot_setColorR(double val) {
-    if (!m_chosenFace) return;
-    m_chosenFace->color.r = val;
-    m_loadedMesh.destroy();
+    if (m_chosenFace == NO_INDEX) return;
+    m_history.begin(m_loadedMesh, MERGE_COLOR);
+    m_history.saveFace(m_chosenFace);
+    m_loadedMesh.faceColor[m_chosenFace].r = val;
+    m_history.end();
+    invalidateLod();
+    m_loadedMesh.markFaceDirty(m_chosenFace);
+    m_loadedMesh.updateDirty();
+    updatePoseDirty({}, {m_chosenFace});
     m_faceDisplay.destroy();
-    m_loadedMesh.create();
     m_faceDisplay.create();
     update();
 }
 
 void MyGL::slot_setColorG(double val) {
-    if (!m_chosenFace) return;
-    m_chosenFace->color.g = val;
-    m_loadedMesh.destroy();
+    if (m_chosenFace == NO_INDEX) return;
+    m_history.begin(m_loadedMesh, MERGE_COLOR);
+    m_history.saveFace(m_chosenFace);
+    m_loadedMesh.faceColor[m_chosenFace].g = val;
+    m_history.end();
+    invalidateLod();
+    m_loadedMesh.markFaceDirty(m_chosenFace);
+    m_loadedMesh.updateDirty();
+    updatePoseDirty({}, {m_chosenFace});
     m_faceDisplay.destroy();
-    m_loadedMesh.create();
     m_faceDisplay.create();
     update();
 }
 
 void MyGL::slot_setColorB(double val) {
-    if (!m_chosenFace) return;
-    m_chosenFace->color.b = val;
-    m_loadedMesh.destroy();
+    if (m_chosenFace == NO_INDEX) return;
+    m_history.begin(m_loadedMesh, MERGE_COLOR);
+    m_history.saveFace(m_chosenFace);
+    m_loadedMesh.faceColor[m_chosenFace].b = val;
+    m_history.end();
+    invalidateLod();
+    m_loadedMesh.markFaceDirty(m_chosenFace);
+    m_loadedMesh.updateDirty();
+    updatePoseDirty({}, {m_chosenFace});
     m_faceDisplay.destroy();
-    m_loadedMesh.create();
     m_faceDisplay.create();
     update();
 }
 
 void MyGL::slot_addVertex() {
-    if (!m_chosenHalfEdge) return;
-    m_loadedMesh.addVertex(m_chosenHalfEdge);
-    m_chosenHalfEdge = nullptr;
+    if (m_chosenHalfEdge == NO_INDEX) return;
+    // splitEdge relinks the edge and its sym, and points their vertices at the new half-edges
+    uint32_t sym = m_loadedMesh.heSym[m_chosenHalfEdge];
+    m_history.begin(m_loadedMesh);
+    m_history.saveHalfEdge(m_chosenHalfEdge);
+    m_history.saveVertex(m_loadedMesh.heVert[m_chosenHalfEdge]);
+    if (sym != NO_INDEX) {
+        m_history.saveHalfEdge(sym);
+        m_history.saveVertex(m_loadedMesh.heVert[sym]);
+    }
+    m_loadedMesh.splitEdge(m_chosenHalfEdge);
+    m_history.end();
+    m_chosenHalfEdge = NO_INDEX;
 
     m_loadedMesh.destroy();
     m_loadedMesh.create();
+    m_bvhNeedsBuild = true;
+    invalidateLod();
+    updatePose();
     emit sig_buildComponentList(&m_loadedMesh);
     update();
 }
 
 void MyGL::slot_triangulate() {
-    if (!m_chosenFace) return;
+    if (m_chosenFace == NO_INDEX) return;
+    m_history.begin(m_loadedMesh);
+    m_history.saveFaceLoop(m_chosenFace);
     m_loadedMesh.triangulate(m_chosenFace);
-    m_chosenFace = nullptr;
+    m_history.end();
+    m_chosenFace = NO_INDEX;
+
+    m_loadedMesh.destroy();
+    m_loadedMesh.create();
+    m_bvhNeedsBuild = true;
+    invalidateLod();
+    updatePose();
+    emit sig_buildComponentList(&m_loadedMesh);
+    update();
+}
+
+void MyGL::slot_triangulateAll() {
+    if (m_loadedMesh.numFaces() == 0) return;
+    // Triangles are left untouched
+    m_history.begin(m_loadedMesh);
+    for (uint32_t face = 0; face < m_loadedMesh.numFaces(); face++) {
+        if (m_loadedMesh.faceDegree(face) > 3) m_history.saveFaceLoop(face);
+    }
+    m_loadedMesh.triangulateAll();
+    m_history.end();
+    m_chosenHalfEdge = NO_INDEX;
+    m_chosenFace = NO_INDEX;
 
     m_loadedMesh.destroy();
     m_loadedMesh.create();
+    m_bvhNeedsBuild = true;
+    invalidateLod();
+    updatePose();
     emit sig_buildComponentList(&m_loadedMesh);
     update();
 }
 
 void MyGL::slot_subdivision() {
-    if (m_loadedMesh.verts.empty()) return;
-    m_loadedMesh.subdivision();
-    m_chosenVertex = nullptr;
-    m_chosenHalfEdge = nullptr;
-    m_chosenFace = nullptr;
+    if (m_loadedMesh.numVerts() == 0) return;
+    m_history.begin(m_loadedMesh);
+    m_history.saveAll();
+    m_loadedMesh.subdivision(m_subdivisionLevels);
+    m_history.end();
+    m_chosenVertex = NO_INDEX;
+    m_chosenHalfEdge = NO_INDEX;
+    m_chosenFace = NO_INDEX;
 
     m_loadedMesh.destroy();
     m_loadedMesh.create();
+    m_bvhNeedsBuild = true;
+    invalidateLod();
+    updatePose();
     emit sig_buildComponentList(&m_loadedMesh);
     update();
 }
 
+void MyGL::slot_subdivideFace() {
+    if (m_chosenFace == NO_INDEX) return;
+    // Each level refines the quads the previous one made of the chosen Face
+    std::vector<uint32_t> region = {m_chosenFace};
+    m_history.begin(m_loadedMesh);
+    for (int i = 0; i < m_subdivisionLevels; i++) {
+        m_history.saveRegion(region);
+        m_loadedMesh.subdivision(region);
+    }
+    m_history.end();
+    m_chosenVertex = NO_INDEX;
+    m_chosenHalfEdge = NO_INDEX;
+    m_chosenFace = NO_INDEX;
+
+    m_loadedMesh.destroy();
+    m_loadedMesh.create();
+    m_bvhNeedsBuild = true;
+    invalidateLod();
+    updatePose();
+    emit sig_buildComponentList(&m_loadedMesh);
+    update();
+}
+
+void MyGL::slot_setSubdivisionLevels(int levels) {
+    m_subdivisionLevels = levels;
+}
+
+void MyGL::slot_setBindInfluences(int influences) {
+    m_bindInfluences = influences;
+}
+
+void MyGL::slot_setSmooth(bool smooth) {
+    m_loadedMesh.buffers.smooth = smooth;
+    m_loadedMesh.destroy();
+    m_loadedMesh.create();
+    m_lodMesh.buffers.smooth = smooth;
+    m_lodMesh.destroy();
+    m_lodMesh.create();
+    updatePose();
+    update();
+}
+
+void MyGL::slot_setCpuSkinning(bool cpuSkinning) {
+    m_cpuSkinning = cpuSkinning;
+    updatePose();
+    update();
+}
+
+void MyGL::slot_setDualQuatSkinning(bool dualQuat) {
+    m_loadedMesh.skinningMethod = dualQuat ? DUAL_QUATERNION : LINEAR_BLEND;
+    updatePose();
+    update();
+}
+
+void MyGL::slot_setInstancedGizmos(bool instanced) {
+    m_instancedGizmos = instanced;
+    updateSkeletonDisplay();
+    update();
+}
+
+void MyGL::slot_loadClip() {
+    if (m_loadedSkeleton.joints.empty()) return;
+    QString fileName = QFileDialog::getOpenFileName(nullptr,
+                                                    tr("Load Clip"), "../jsons", tr(".json Files (*.json)"));
+    if (fileName.isNull()) return;
+
+    std::vector<QString> names;
+    for (const uPtr<Joint> &joint : m_loadedSkeleton.joints) {
+        names.push_back(joint->name);
+    }
+    if (!SkeletonJson::loadClip(fileName, names, m_clip)) {
+        qWarning() << "Could not load" << fileName;
+        return;
+    }
+    if (m_cachePoses) m_clip.cachePoses(ANIMATION_FPS);
+    m_animationClock.restart();
+}
+
+void MyGL::slot_setPlaying(bool playing) {
+    if (playing) {
+        m_animationClock.start();
+        m_animationTimer.start();
+    } else {
+        m_animationTimer.stop();
+    }
+}
+
+void MyGL::slot_setCachePoses(bool cache) {
+    m_cachePoses = cache;
+    if (cache) {
+        m_clip.cachePoses(ANIMATION_FPS);
+    } else {
+        m_clip.clearCache();
+    }
+}
+
+void MyGL::slot_setLod(bool lod) {
+    m_lodEnabled = lod;
+    updateLod();
+    update();
+}
+
+void MyGL::slot_setLodTriangles(int triangles) {
+    m_lodTriangles = triangles;
+    invalidateLod();
+}
+
+void MyGL::slot_undo() {
+    if (m_history.undo(m_loadedMesh)) updateAfterHistory();
+}
+
+void MyGL::slot_redo() {
+    if (m_history.redo(m_loadedMesh)) updateAfterHistory();
+}
+
+void MyGL::updateAfterHistory() {
+    const MeshHistory::Change &change = m_history.lastChange();
+    if (change.onlyPositionsAndColors) {
+        for (uint32_t vert : change.verts) m_loadedMesh.markVertexDirty(vert);
+        for (uint32_t face : change.faces) m_loadedMesh.markFaceDirty(face);
+        m_loadedMesh.updateDirty();
+        m_bvhNeedsRefit = true;
+        updatePoseDirty(change.verts, change.faces);
+    } else {
+        m_loadedMesh.destroy();
+        m_loadedMesh.create();
+        m_bvhNeedsBuild = true;
+        emit sig_buildComponentList(&m_loadedMesh);
+        updatePose();
+    }
+    invalidateLod();
+
+    if (m_chosenVertex >= m_loadedMesh.numVerts()) m_chosenVertex = NO_INDEX;
+    if (m_chosenHalfEdge >= m_loadedMesh.numHalfEdges()) m_chosenHalfEdge = NO_INDEX;
+    if (m_chosenFace >= m_loadedMesh.numFaces()) m_chosenFace = NO_INDEX;
+    m_vertDisplay.destroy();
+    m_halfEdgeDisplay.destroy();
+    m_faceDisplay.destroy();
+    m_vertDisplay.updateVertex(&m_loadedMesh, m_chosenVertex);
+    m_halfEdgeDisplay.updateHalfEdge(&m_loadedMesh, m_chosenHalfEdge);
+    m_faceDisplay.updateFace(&m_loadedMesh, m_chosenFace);
+    m_vertDisplay.create();
+    m_halfEdgeDisplay.create();
+    m_faceDisplay.create();
+
+    // Show the restored values in the spin boxes
+    if (m_chosenVertex != NO_INDEX) {
+        glm::vec3 pos = m_loadedMesh.position(m_chosenVertex);
+        emit sig_updatePosition(QVector3D(pos.x, pos.y, pos.z));
+    }
+    if (m_chosenFace != NO_INDEX) {
+        const glm::vec3 &color = m_loadedMesh.faceColor[m_chosenFace];
+        emit sig_updateColor(QColor::fromRgbF(color.r, color.g, color.b));
+    }
+    update();
+}
+
+void MyGL::invalidateLod() {
+    m_lodNeedsBuild = true;
+    m_lodGeneration++;
+    if (m_lodEnabled) m_lodTimer.start();
+}
+
+void MyGL::updateLod() {
+    m_lodTimer.stop();
+    if (!m_lodEnabled || !m_lodNeedsBuild || m_lodThread || m_loadedMesh.numFaces() == 0) return;
+
+    // Decimation takes seconds on large meshes, so it runs on a copy away from the GUI thread
+    uint32_t generation = m_lodGeneration;
+    uint32_t triangles = m_lodTriangles;
+    auto source = std::make_shared<HalfEdgeMesh>(m_loadedMesh);
+    auto result = std::make_shared<HalfEdgeMesh>();
+    m_lodThread = QThread::create([source, result, triangles]() {
+        Decimation::decimate(*source, triangles, *result);
+    });
+    m_lodThread->setParent(this);
+    connect(m_lodThread, &QThread::finished, this, [this, generation, result]() {
+        m_lodThread->deleteLater();
+        m_lodThread = nullptr;
+        if (generation != m_lodGeneration) {
+            // The mesh changed during the build, start over unless more edits are on the way
+            if (!m_lodTimer.isActive()) updateLod();
+            return;
+        }
+
+        makeCurrent();
+        static_cast<HalfEdgeMesh&>(m_lodMesh) = std::move(*result);
+        m_lodMesh.buffers.smooth = m_loadedMesh.buffers.smooth;
+        m_lodMesh.destroy();
+        m_lodMesh.create();
+        m_lodNeedsBuild = false;
+        update();
+    });
+    m_lodThread->start();
+}
+
+void MyGL::updateSkeletonDisplay() {
+    if (m_instancedGizmos) {
+        m_jointGizmos.update(m_loadedSkeleton.getTransformations(), m_loadedSkeleton.hierarchy.parent,
+                             m_loadedSkeleton.chosenJoint);
+    } else {
+        m_loadedSkeleton.destroy();
+        m_loadedSkeleton.create();
+    }
+}
+
+void MyGL::updatePose() {
+    if (m_loadedSkeleton.hierarchy.size() == 0) return;
+    // Only the palette of the mesh's skinning method is built and uploaded
+    const bool dualQuat = m_loadedMesh.skinningMethod == DUAL_QUATERNION;
+    if (dualQuat) {
+        Skinning::buildDualQuatPalette(m_loadedSkeleton.getTransformations(), m_loadedSkeleton.hierarchy.bind, m_dualQuats);
+        m_jointPalette.upload(m_dualQuats);
+    } else {
+        Skinning::buildPalette(m_loadedSkeleton.getTransformations(), m_loadedSkeleton.hierarchy.bind, m_palette);
+        m_jointPalette.upload(m_palette);
+    }
+    // The posed positions picking works on have moved
+    m_bvhNeedsRefit = true;
+
+    if (!m_cpuSkinning || m_loadedMesh.numVerts() == 0 || m_loadedMesh.vertSkin[0].empty()) return;
+
+    // Topology and colors come from the rest mesh, positions from the skeleton
+    static_cast<HalfEdgeMesh&>(m_posedMesh) = m_loadedMesh;
+    m_posedMesh.buffers.smooth = m_loadedMesh.buffers.smooth;
+
+    if (dualQuat) {
+        Skinning::skin(m_loadedMesh, m_dualQuats, m_posedMesh);
+    } else {
+        Skinning::skin(m_loadedMesh, m_palette, m_posedMesh);
+    }
+
+    m_posedMesh.destroy();
+    m_posedMesh.create();
+}
+
+void MyGL::updatePoseDirty(const std::vector<uint32_t> &verts, const std::vector<uint32_t> &faces) {
+    if (!m_cpuSkinning || m_loadedMesh.numVerts() == 0 || m_loadedMesh.vertSkin[0].empty()) return;
+    if (m_posedMesh.numVerts() != m_loadedMesh.numVerts() || m_posedMesh.numHalfEdges() != m_loadedMesh.numHalfEdges() ||
+        m_posedMesh.numFaces() != m_loadedMesh.numFaces()) {
+        updatePose();
+        return;
+    }
+
+    // The palette of the current pose is still the one updatePose built
+    if (m_loadedMesh.skinningMethod == DUAL_QUATERNION) {
+        Skinning::skinVertices(m_loadedMesh, m_dualQuats, verts, m_posedMesh);
+    } else {
+        Skinning::skinVertices(m_loadedMesh, m_palette, verts, m_posedMesh);
+    }
+    for (uint32_t vert : verts) m_posedMesh.markVertexDirty(vert);
+    for (uint32_t face : faces) {
+        m_posedMesh.faceColor[face] = m_loadedMesh.faceColor[face];
+        m_posedMesh.markFaceDirty(face);
+    }
+    m_posedMesh.updateDirty();
+}
+
+void MyGL::mousePressEvent(QMouseEvent *e)
+{
+    if (e->button() != Qt::LeftButton || m_loadedMesh.numFaces() == 0) return;
+
+    // Pick what is on screen, which for a bound mesh are the posed positions
+    const HalfEdgeMesh *target = &m_loadedMesh;
+    if (m_loadedSkeleton.hierarchy.size() > 0 && !m_loadedMesh.vertSkin[0].empty()) {
+        if (m_cpuSkinning) {
+            target = &m_posedMesh;
+        } else {
+            // Skinned on the GPU: pose a copy with the palette updatePose uploaded
+            if (m_bvhNeedsBuild || m_bvhNeedsRefit) {
+                m_pickMesh = m_loadedMesh;
+                if (m_loadedMesh.skinningMethod == DUAL_QUATERNION) {
+                    Skinning::skin(m_loadedMesh, m_dualQuats, m_pickMesh);
+                } else {
+                    Skinning::skin(m_loadedMesh, m_palette, m_pickMesh);
+                }
+            }
+            target = &m_pickMesh;
+        }
+    }
+
+    if (m_bvhNeedsBuild) {
+        m_faceBvh.build(*target);
+    } else if (m_bvhNeedsRefit) {
+        m_faceBvh.refit(*target);
+    }
+    m_bvhNeedsBuild = false;
+    m_bvhNeedsRefit = false;
+
+    float ndcX = 2.f * e->position().x() / width() - 1.f;
+    float ndcY = 1.f - 2.f * e->position().y() / height();
+    glm::vec3 origin, direction;
+    m_glCamera.Raycast(ndcX, ndcY, origin, direction);
+
+    FaceBvh::Pick pick;
+    if (m_faceBvh.pick(*target, origin, direction, pick)) {
+        emit sig_picked(pick.vert, pick.halfEdge, pick.face);
+    }
+}
+
 void MyGL::keyPressEvent(QKeyEvent *e)
 {
     float amount = 2.0f;
     if(e->modifiers() & Qt::ShiftModifier){
         amount = 10.0f;
     }
+    bool cameraMoved = true;
     // http://doc.qt.io/qt-5/qt.html#Key-enum
     // This could all be much more efficient if a switch
     // statement were used
@@ -646,51 +1016,52 @@ void MyGL::keyPressEvent(QKeyEvent *e)
     } else if (e->key() == Qt::Key_R) {
         m_glCamera = Camera(width(), height());
     } else {
+        cameraMoved = false;
         if (e->key() == Qt::Key_N) {
             // NEXT half-edge of the currently selected half-edge
-            if (!m_chosenHalfEdge) return;
-            m_chosenHalfEdge = m_chosenHalfEdge->next;
-            m_chosenVertex = nullptr;
-            m_chosenFace = nullptr;
+            if (m_chosenHalfEdge == NO_INDEX) return;
+            m_chosenHalfEdge = m_loadedMesh.heNext[m_chosenHalfEdge];
+            m_chosenVertex = NO_INDEX;
+            m_chosenFace = NO_INDEX;
         } else if (e->key() == Qt::Key_M) {
             // SYM half-edge of the currently selected half-edge
-            if (!m_chosenHalfEdge) return;
-            m_chosenHalfEdge = m_chosenHalfEdge->sym;
-            m_chosenVertex = nullptr;
-            m_chosenFace = nullptr;
+            if (m_chosenHalfEdge == NO_INDEX || m_loadedMesh.heSym[m_chosenHalfEdge] == NO_INDEX) return;
+            m_chosenHalfEdge = m_loadedMesh.heSym[m_chosenHalfEdge];
+            m_chosenVertex = NO_INDEX;
+            m_chosenFace = NO_INDEX;
         } else if (e->key() == Qt::Key_F) {
             // FACE of the currently selected half-edge
-            if (!m_chosenHalfEdge) return;
-            m_chosenFace = m_chosenHalfEdge->face;
-            m_chosenHalfEdge = nullptr;
-            m_chosenVertex = nullptr;
+            if (m_chosenHalfEdge == NO_INDEX) return;
+            m_chosenFace = m_loadedMesh.heFace[m_chosenHalfEdge];
+            m_chosenHalfEdge = NO_INDEX;
+            m_chosenVertex = NO_INDEX;
         } else if (e->key() == Qt::Key_V) {
             // VERTEX of the currently selected half-edge
-            if (!m_chosenHalfEdge) return;
-            m_chosenVertex = m_chosenHalfEdge->vert;
-            m_chosenHalfEdge = nullptr;
-            m_chosenFace = nullptr;
+            if (m_chosenHalfEdge == NO_INDEX) return;
+            m_chosenVertex = m_loadedMesh.heVert[m_chosenHalfEdge];
+            m_chosenHalfEdge = NO_INDEX;
+            m_chosenFace = NO_INDEX;
         } else if (e->modifiers() == Qt::ShiftModifier && e->key() == Qt::Key_H) {
             // HALF-EDGE of the currently selected face
-            if (!m_chosenFace) return;
-            m_chosenHalfEdge = m_chosenFace->edge;
-            m_chosenVertex = nullptr;
-            m_chosenFace = nullptr;
+            if (m_chosenFace == NO_INDEX) return;
+            m_chosenHalfEdge = m_loadedMesh.faceEdge[m_chosenFace];
+            m_chosenVertex = NO_INDEX;
+            m_chosenFace = NO_INDEX;
         } else if (e->key() == Qt::Key_H) {
             // HALF-EDGE of the currently selected vertex
-            if (!m_chosenVertex) return;
-            m_chosenHalfEdge = m_chosenVertex->edge;
-            m_chosenVertex = nullptr;
-            m_chosenFace = nullptr;
+            if (m_chosenVertex == NO_INDEX) return;
+            m_chosenHalfEdge = m_loadedMesh.vertEdge[m_chosenVertex];
+            m_chosenVertex = NO_INDEX;
+            m_chosenFace = NO_INDEX;
         }
 
         m_vertDisplay.destroy();
         m_halfEdgeDisplay.destroy();
         m_faceDisplay.destroy();
 
-        m_vertDisplay.updateVertex(m_chosenVertex);
-        m_halfEdgeDisplay.updateHalfEdge(m_chosenHalfEdge);
-        m_faceDisplay.updateFace(m_chosenFace);
+        m_vertDisplay.updateVertex(&m_loadedMesh, m_chosenVertex);
+        m_halfEdgeDisplay.updateHalfEdge(&m_loadedMesh, m_chosenHalfEdge);
+        m_faceDisplay.updateFace(&m_loadedMesh, m_chosenFace);
 
         m_vertDisplay.create();
         m_halfEdgeDisplay.create();
@@ -700,5 +1071,11 @@ void MyGL::keyPressEvent(QKeyEvent *e)
 
 
     m_glCamera.RecomputeAttributes();
+    if (cameraMoved && m_lodEnabled) {
+        // Draw the LOD until the camera rests
+        updateLod();
+        m_cameraMoving = true;
+        m_idleTimer.start();
+    }
     update();  // Calls paintGL, among other things
 }
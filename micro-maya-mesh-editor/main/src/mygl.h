@@ -5,15 +5,23 @@
 #include <utils.h>
 #include <shaderprogram.h>
 #include <scene/squareplane.h>
+#include "animationclip.h"
 #include "camera.h"
+#include "facebvh.h"
 #include "facedisplay.h"
 #include "halfedgedisplay.h"
+#include "jointgizmos.h"
+#include "jointpalette.h"
 #include "mesh.h"
+#include "meshhistory.h"
 #include "skeleton.h"
 #include "vertexdisplay.h"
 
+#include <QElapsedTimer>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLShaderProgram>
+#include <QThread>
+#include <QTimer>
 
 
 class MyGL
@@ -25,12 +33,44 @@ private:
     ShaderProgram m_progLambert;// A shader program that uses lambertian reflection
     ShaderProgram m_progFlat;// A shader program that uses "flat" reflection (no shadowing at all)
     ShaderProgram m_progSkeleton;// A shader program rendering skeleton
+    ShaderProgram m_progSkeletonDq;// A shader program rendering skeleton with dual quaternion skinning
+    ShaderProgram m_progGizmo;// A shader program drawing one joint gizmo per instance
 
     GLuint vao; // A handle for our vertex array object. This will store the VBOs created in our geometry classes.
                 // Don't worry too much about this. Just know it is necessary in order to render geometry.
 
     Camera m_glCamera;
 
+    // The skinning transformations of the current pose, on the CPU and in a texture buffer,
+    // as matrices or dual quaternions depending on m_loadedMesh's skinning method
+    std::vector<glm::mat4> m_palette;
+    std::vector<DualQuat> m_dualQuats;
+    JointPalette m_jointPalette;
+
+    // The joints drawn instanced from one gizmo mesh, instead of m_loadedSkeleton's lines
+    JointGizmos m_jointGizmos;
+    bool m_instancedGizmos;
+
+    // Show the skeleton's current pose and selection, by updating m_jointGizmos' changed records
+    // or, with instancing off, by rebuilding every line of m_loadedSkeleton
+    void updateSkeletonDisplay();
+
+    // Upload the skeleton's current pose to m_jointPalette, and re-skin m_posedMesh from m_loadedMesh
+    // with it when CPU skinning is on
+    void updatePose();
+    // Bring m_posedMesh up to date after an edit that kept the topology, re-skinning only the given
+    // vertices, copying the given faces' colors and uploading only the corners they touch
+    void updatePoseDirty(const std::vector<uint32_t> &verts, const std::vector<uint32_t> &faces);
+
+    // Mark m_lodMesh out of date after an edit, to be rebuilt once edits pause
+    void invalidateLod();
+    // Start decimating m_loadedMesh into m_lodMesh in the background if it is out of date
+    void updateLod();
+
+    // Show m_loadedMesh after an undo or redo, re-uploading only the changed vertices and faces
+    // when its topology is unchanged, and drop the selections that no longer exist
+    void updateAfterHistory();
+
 public:
     explicit MyGL(QWidget *parent = nullptr);
     ~MyGL();
@@ -42,23 +82,73 @@ public:
     Mesh m_loadedMesh;
     Skeleton m_loadedSkeleton;
 
-    Vertex* m_chosenVertex;
-    HalfEdge* m_chosenHalfEdge;
-    Face* m_chosenFace;
+    // m_loadedMesh deformed by the skeleton on the CPU, drawn with the Lambert shader
+    Mesh m_posedMesh;
+    // Whether a bound mesh is skinned on the CPU instead of in skeleton.vert.glsl or skeleton_dq.vert.glsl
+    bool m_cpuSkinning;
+    // Whether slot_exportMesh writes the posed positions of a bound mesh instead of its rest positions
+    bool m_exportPosed;
+
+    // Edits of m_loadedMesh, undone with Ctrl+Z and redone with Ctrl+Y
+    MeshHistory m_history;
+
+    // Indices into m_loadedMesh, NO_INDEX when nothing is selected
+    uint32_t m_chosenVertex;
+    uint32_t m_chosenHalfEdge;
+    uint32_t m_chosenFace;
 
     VertexDisplay m_vertDisplay;
     HalfEdgeDisplay m_halfEdgeDisplay;
     FaceDisplay m_faceDisplay;
 
+    // How many levels of subdivision slot_subdivision applies at once
+    int m_subdivisionLevels;
+
+    // How many joints slot_bindMesh lets influence each vertex
+    int m_bindInfluences;
+
+    // Faces of m_loadedMesh for mouse picking, rebuilt lazily after topology changes
+    // and refit after vertices move or the pose changes. A posed mesh is picked as drawn,
+    // through m_posedMesh or, when it is skinned on the GPU, through m_pickMesh.
+    FaceBvh m_faceBvh;
+    bool m_bvhNeedsBuild;
+    bool m_bvhNeedsRefit;
+    HalfEdgeMesh m_pickMesh;
+
+    // A decimated copy of m_loadedMesh drawn instead of it while the camera moves.
+    // m_lodThread decimates a snapshot of the mesh, and the result is only swapped in
+    // if m_lodGeneration shows the mesh has not been edited since.
+    Mesh m_lodMesh;
+    bool m_lodEnabled;
+    bool m_lodNeedsBuild;
+    int m_lodTriangles;
+    QThread *m_lodThread;
+    uint32_t m_lodGeneration;
+    // Holds the build back until edits and triangle count changes pause
+    QTimer m_lodTimer;
+    // Set by camera keys, cleared by m_idleTimer once the camera has not moved for a moment
+    bool m_cameraMoving;
+    QTimer m_idleTimer;
+
+    // The clip played on m_loadedSkeleton, sampled on every tick of m_animationTimer
+    // at the time m_animationClock has been running
+    AnimationClip m_clip;
+    QTimer m_animationTimer;
+    QElapsedTimer m_animationClock;
+    // Whether m_clip's poses are cached at the playback rate
+    bool m_cachePoses;
+
 
 public slots:
     void slot_loadMesh();
+    void slot_exportMesh();
+    void slot_setExportPosed(bool);
     void slot_loadSkeleton();
     void slot_bindMesh();
 
-    void slot_setChosenVertex(QListWidgetItem*);
-    void slot_setChosenHalfEdge(QListWidgetItem*);
-    void slot_setChosenFace(QListWidgetItem*);
+    void slot_setChosenVertex(const QModelIndex&);
+    void slot_setChosenHalfEdge(const QModelIndex&);
+    void slot_setChosenFace(const QModelIndex&);
     void slot_setChosenJoint(QTreeWidgetItem*);
 
     void slot_setPositionX(double);
@@ -82,7 +172,22 @@ public slots:
 
     void slot_addVertex();
     void slot_triangulate();
+    void slot_triangulateAll();
     void slot_subdivision();
+    void slot_subdivideFace();
+    void slot_setSubdivisionLevels(int);
+    void slot_setSmooth(bool);
+    void slot_setBindInfluences(int);
+    void slot_setCpuSkinning(bool);
+    void slot_setDualQuatSkinning(bool);
+    void slot_setInstancedGizmos(bool);
+    void slot_setLod(bool);
+    void slot_loadClip();
+    void slot_setPlaying(bool);
+    void slot_setCachePoses(bool);
+    void slot_setLodTriangles(int);
+    void slot_undo();
+    void slot_redo();
 
 signals:
     void sig_buildComponentList(Mesh*);
@@ -92,8 +197,11 @@ signals:
     void sig_updateColor(const QColor&);
     void sig_updateJointPos(const QVector3D&);
     void sig_updateRotation(const QVector3D&);
+    // The vertex, half-edge and face under the mouse
+    void sig_picked(uint32_t vert, uint32_t halfEdge, uint32_t face);
 protected:
     void keyPressEvent(QKeyEvent *e);
+    void mousePressEvent(QMouseEvent *e);
 };
 
 
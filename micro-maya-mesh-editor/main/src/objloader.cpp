@@ -0,0 +1,287 @@
+#include "objloader.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+const char *skipBlanks(const char *p, const char *end) {
+    while (p < end && isBlank(*p)) p++;
+    return p;
+}
+
+const char *skipLine(const char *p, const char *end) {
+    while (p < end && *p != '\n') p++;
+    return p < end ? p + 1 : end;
+}
+
+// Parse [+-]digits[.digits][(e|E)[+-]digits] without going through the C locale
+const char *parseFloat(const char *p, const char *end, float &out) {
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    p = skipBlanks(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for (; p < end && isDigit(*p); p++) {
+        // Digits beyond what a uint64 holds exactly only shift the exponent
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits++;
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && isDigit(*p); p++) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits++;
+                exponent--;
+            }
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            p++;
+        }
+        int value = 0;
+        for (; p < end && isDigit(*p); p++) {
+            if (value < 10000) value = value * 10 + (*p - '0');
+        }
+        exponent += negativeExponent ? -value : value;
+    }
+
+    double result = (double)mantissa;
+    if (exponent < 0) {
+        result = -exponent <= 22 ? result / powers[-exponent] : result * std::pow(10.0, exponent);
+    } else if (exponent > 0) {
+        result = exponent <= 22 ? result * powers[exponent] : result * std::pow(10.0, exponent);
+    }
+    out = (float)(negative ? -result : result);
+    return p;
+}
+
+// Parse the vertex index of one face corner "v", "v/vt", "v//vn" or "v/vt/vn", 1-based or negative
+const char *parseCorner(const char *p, const char *end, long &out) {
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        p++;
+    }
+    long value = 0;
+    for (; p < end && isDigit(*p); p++) {
+        value = value * 10 + (*p - '0');
+    }
+    out = negative ? -value : value;
+
+    // Texture and normal indices are not used by the mesh
+    while (p < end && !isBlank(*p) && *p != '\n') p++;
+    return p;
+}
+
+// Sort values by keys with a least significant digit radix sort on 16-bit digits.
+// Passes over digits that are the same for every key are skipped.
+void radixSort(std::vector<uint64_t> &keys, std::vector<uint32_t> &values) {
+    const size_t n = keys.size();
+    std::vector<uint64_t> keysTmp(n);
+    std::vector<uint32_t> valuesTmp(n);
+    std::vector<uint32_t> offsets(1 << 16);
+
+    for (int shift = 0; shift < 64; shift += 16) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (size_t i = 0; i < n; i++) {
+            offsets[(keys[i] >> shift) & 0xFFFF]++;
+        }
+        if (n == 0 || offsets[(keys[0] >> shift) & 0xFFFF] == n) continue;
+
+        uint32_t sum = 0;
+        for (auto &offset : offsets) {
+            uint32_t count = offset;
+            offset = sum;
+            sum += count;
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint32_t dst = offsets[(keys[i] >> shift) & 0xFFFF]++;
+            keysTmp[dst] = keys[i];
+            valuesTmp[dst] = values[i];
+        }
+        keys.swap(keysTmp);
+        values.swap(valuesTmp);
+    }
+}
+
+} // namespace
+
+bool ObjLoader::load(const std::string &path, HalfEdgeMesh &mesh) {
+    mesh.clear();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void *data = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+    ::madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+    const char *begin = static_cast<const char*>(data);
+    bool ok = parse(begin, begin + info.st_size, mesh);
+    ::munmap(data, info.st_size);
+    return ok;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::vector<char> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parse(buffer.data(), buffer.data() + buffer.size(), mesh);
+#endif
+}
+
+bool ObjLoader::parse(const char *begin, const char *end, HalfEdgeMesh &mesh) {
+    // Examples
+    // v 2.229345 -0.992723 -0.862826 vertex
+    // f 947/644/5398 967/670/5399 948/614/5400 vertex/texture/normal
+    mesh.clear();
+    std::vector<uint32_t> corners;
+
+    const char *p = begin;
+    while (p < end) {
+        p = skipBlanks(p, end);
+        if (end - p > 1 && p[0] == 'v' && isBlank(p[1])) {
+            glm::vec3 pos;
+            p = parseFloat(p + 1, end, pos.x);
+            p = parseFloat(p, end, pos.y);
+            p = parseFloat(p, end, pos.z);
+            mesh.posX.push_back(pos.x);
+            mesh.posY.push_back(pos.y);
+            mesh.posZ.push_back(pos.z);
+
+        } else if (end - p > 1 && p[0] == 'f' && isBlank(p[1])) {
+            corners.clear();
+            p = skipBlanks(p + 1, end);
+            while (p < end && *p != '\n') {
+                long index;
+                p = parseCorner(p, end, index);
+                // Negative indices count back from the last vertex read so far
+                long vert = index > 0 ? index - 1 : (long)mesh.posX.size() + index;
+                if (index == 0 || vert < 0) {
+                    mesh.clear();
+                    return false;
+                }
+                corners.push_back(vert);
+                p = skipBlanks(p, end);
+            }
+            if (corners.size() < 3) {
+                mesh.clear();
+                return false;
+            }
+
+            uint32_t face = mesh.addFace(HalfEdgeMesh::getRandomColor());
+            uint32_t first = mesh.numHalfEdges();
+            uint32_t numCorners = corners.size();
+            for (uint32_t i = 0; i < numCorners; i++) {
+                mesh.heNext.push_back(first + (i + 1) % numCorners);
+                mesh.heFace.push_back(face);
+                mesh.heVert.push_back(corners[i]);
+            }
+            mesh.faceEdge[face] = first;
+        }
+        p = skipLine(p, end);
+    }
+
+    const uint32_t numVerts = mesh.posX.size();
+    mesh.vertEdge.assign(numVerts, NO_INDEX);
+    mesh.vertSkin.assign(numVerts, SkinInfluences());
+    for (uint32_t h = 0; h < mesh.numHalfEdges(); h++) {
+        if (mesh.heVert[h] >= numVerts) {
+            mesh.clear();
+            return false;
+        }
+        mesh.vertEdge[mesh.heVert[h]] = h;
+    }
+
+    pairSyms(mesh);
+    return true;
+}
+
+void ObjLoader::pairSyms(HalfEdgeMesh &mesh) {
+    const uint32_t numHalfEdges = mesh.numHalfEdges();
+
+    // The vertex each HalfEdge starts from is the one its predecessor points to
+    std::vector<uint32_t> source(numHalfEdges);
+    for (uint32_t h = 0; h < numHalfEdges; h++) {
+        source[mesh.heNext[h]] = mesh.heVert[h];
+    }
+
+    // Both HalfEdges of an edge share the key (min vertex, max vertex)
+    std::vector<uint64_t> keys(numHalfEdges);
+    std::vector<uint32_t> edges(numHalfEdges);
+    for (uint32_t h = 0; h < numHalfEdges; h++) {
+        uint64_t a = source[h];
+        uint64_t b = mesh.heVert[h];
+        keys[h] = a < b ? (a << 32) | b : (b << 32) | a;
+        edges[h] = h;
+    }
+    radixSort(keys, edges);
+
+    mesh.heSym.assign(numHalfEdges, NO_INDEX);
+    for (uint32_t i = 0; i < numHalfEdges;) {
+        uint32_t j = i + 1;
+        while (j < numHalfEdges && keys[j] == keys[i]) j++;
+
+        // Pair HalfEdges of opposite directions within the run.
+        // A run longer than two is a non-manifold edge, whatever is left unpaired stays a boundary.
+        for (uint32_t a = i; a < j; a++) {
+            uint32_t ha = edges[a];
+            if (mesh.heSym[ha] != NO_INDEX) continue;
+            for (uint32_t b = a + 1; b < j; b++) {
+                uint32_t hb = edges[b];
+                if (mesh.heSym[hb] == NO_INDEX && source[hb] == mesh.heVert[ha] && mesh.heVert[hb] == source[ha]) {
+                    mesh.heSym[ha] = hb;
+                    mesh.heSym[hb] = ha;
+                    break;
+                }
+            }
+        }
+        i = j;
+    }
+}
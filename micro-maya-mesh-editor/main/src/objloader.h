@@ -0,0 +1,25 @@
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+
+#include "halfedgemesh.h"
+#include <string>
+
+// Builds a HalfEdgeMesh from the "v" and "f" lines of a Wavefront .obj file.
+// The file is parsed in place from a memory-mapped buffer, and sym HalfEdges are paired
+// by radix sorting one packed 64-bit key per HalfEdge instead of looking them up in a map.
+class ObjLoader
+{
+public:
+    // Replace the content of mesh with the file at path.
+    // Returns false and leaves mesh empty if the file cannot be read or a face is invalid.
+    static bool load(const std::string &path, HalfEdgeMesh &mesh);
+
+    // Same as load() on a buffer holding the content of a .obj file
+    static bool parse(const char *begin, const char *end, HalfEdgeMesh &mesh);
+
+    // Set heSym of every HalfEdge whose opposite HalfEdge exists, NO_INDEX otherwise.
+    // Expects heVert, heNext to be complete.
+    static void pairSyms(HalfEdgeMesh &mesh);
+};
+
+#endif // OBJLOADER_H
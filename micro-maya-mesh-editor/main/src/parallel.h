@@ -0,0 +1,36 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/// Call func(i) for every i in [begin, end), split into contiguous chunks over the hardware threads.
+/// Ranges smaller than grain run on the calling thread. func must only write state owned by i.
+template<typename Func>
+inline void parallelFor(uint32_t begin, uint32_t end, const Func &func, uint32_t grain = 4096) {
+    uint32_t count = end > begin ? end - begin : 0;
+    uint32_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = std::min(numThreads, (count + grain - 1) / std::max(1u, grain));
+
+    if (numThreads <= 1) {
+        for (uint32_t i = begin; i < end; i++) func(i);
+        return;
+    }
+
+    uint32_t chunk = (count + numThreads - 1) / numThreads;
+    std::vector<std::thread> workers;
+    workers.reserve(numThreads - 1);
+    for (uint32_t t = 1; t < numThreads; t++) {
+        uint32_t first = begin + t * chunk;
+        uint32_t last = std::min(end, first + chunk);
+        workers.emplace_back([&func, first, last]() {
+            for (uint32_t i = first; i < last; i++) func(i);
+        });
+    }
+    for (uint32_t i = begin; i < std::min(end, begin + chunk); i++) func(i);
+    for (auto &worker : workers) worker.join();
+}
+
+#endif // PARALLEL_H
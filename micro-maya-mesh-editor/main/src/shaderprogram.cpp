@@ -9,7 +9,7 @@ ShaderProgram::ShaderProgram(OpenGLContext *context)
     : vertShader(), fragShader(), prog(),
     attrPos(-1), attrNor(-1), attrCol(-1), attrJoints(-1), attrWeights(-1),
     unifModel(-1), unifModelInvTr(-1), unifViewProj(-1), unifCamPos(-1),
-    unifTransformations(-1), unifBinds(-1),
+    unifPalette(-1), unifInstances(-1),
     context(context)
 {}
 
@@ -71,8 +71,8 @@ void ShaderProgram::create(const char *vertfile, const char *fragfile)
     unifModelInvTr = context->glGetUniformLocation(prog, "u_ModelInvTr");
     unifViewProj   = context->glGetUniformLocation(prog, "u_ViewProj");
     unifCamPos      = context->glGetUniformLocation(prog, "u_CamPos");
-    unifTransformations = context->glGetUniformLocation(prog, "u_Transformations");
-    unifBinds      = context->glGetUniformLocation(prog, "u_Binds");
+    unifPalette    = context->glGetUniformLocation(prog, "u_Palette");
+    unifInstances  = context->glGetUniformLocation(prog, "u_Instances");
 }
 
 void ShaderProgram::useMe()
@@ -138,44 +138,26 @@ void ShaderProgram::setCamPos(glm::vec3 pos)
     }
 }
 
-void ShaderProgram::setTransformationMatrices(const std::vector<glm::mat4> &transformations)
+void ShaderProgram::setPaletteUnit(int unit)
 {
-    // Tell OpenGL to use this shader program for subsequent function calls
     useMe();
 
-    if(unifTransformations != -1) {
-        // Pass a 4x4 matrix into a uniform variable in our shader
-        // Handle to the matrix variable on the GPU
-        context->glUniformMatrix4fv(unifTransformations,
-                                    // How many matrices to pass
-                                    transformations.size(),
-                                    // Transpose the matrix? OpenGL uses column-major, so no.
-                                    GL_FALSE,
-                                    // Pointer to the first element of the matrix
-                                    &transformations[0][0][0]);
+    if(unifPalette != -1) {
+        context->glUniform1i(unifPalette, unit);
     }
 }
 
-void ShaderProgram::setBindMatrices(const std::vector<glm::mat4> &binds)
+void ShaderProgram::setInstanceUnit(int unit)
 {
-    // Tell OpenGL to use this shader program for subsequent function calls
     useMe();
 
-    if(unifBinds != -1) {
-        // Pass a 4x4 matrix into a uniform variable in our shader
-        // Handle to the matrix variable on the GPU
-        context->glUniformMatrix4fv(unifBinds,
-                                    // How many matrices to pass
-                                    binds.size(),
-                                    // Transpose the matrix? OpenGL uses column-major, so no.
-                                    GL_FALSE,
-                                    // Pointer to the first element of the matrix
-                                    &binds[0][0][0]);
+    if(unifInstances != -1) {
+        context->glUniform1i(unifInstances, unit);
     }
 }
 
 //This function, as its name implies, uses the passed in GL widget
-void ShaderProgram::draw(Drawable &d)
+void ShaderProgram::draw(Drawable &d, int instances)
 {
     if(d.elemCount() < 0) {
         throw std::invalid_argument(
@@ -210,18 +192,22 @@ void ShaderProgram::draw(Drawable &d)
 
     if (attrJoints != -1 && d.bindJoints()) {
         context->glEnableVertexAttribArray(attrJoints);
-        context->glVertexAttribIPointer(attrJoints, 2, GL_INT, 0, nullptr);
+        context->glVertexAttribIPointer(attrJoints, 4, GL_UNSIGNED_SHORT, 0, nullptr);
     }
 
     if (attrWeights != -1 && d.bindWeights()) {
         context->glEnableVertexAttribArray(attrWeights);
-        context->glVertexAttribPointer(attrWeights, 2, GL_FLOAT, false, 0, nullptr);
+        context->glVertexAttribPointer(attrWeights, 4, GL_UNSIGNED_SHORT, true, 0, nullptr);
     }
 
     // Bind the index buffer and then draw shapes from it.
     // This invokes the shader program, which accesses the vertex buffers.
     d.bindIdx();
-    context->glDrawElements(d.drawMode(), d.elemCount(), GL_UNSIGNED_INT, 0);
+    if (instances == 1) {
+        context->glDrawElements(d.drawMode(), d.elemCount(), GL_UNSIGNED_INT, 0);
+    } else {
+        context->glDrawElementsInstanced(d.drawMode(), d.elemCount(), GL_UNSIGNED_INT, 0, instances);
+    }
 
     if (attrPos != -1) context->glDisableVertexAttribArray(attrPos);
     if (attrNor != -1) context->glDisableVertexAttribArray(attrNor);
@@ -18,15 +18,15 @@ public:
     int attrPos; // A handle for the "in" vec4 representing vertex position in the vertex shader
     int attrNor; // A handle for the "in" vec4 representing vertex normal in the vertex shader
     int attrCol; // A handle for the "in" vec4 representing vertex color in the vertex shader
-    int attrJoints; // A handle for the "in" vec2 representing the joints inflencing this vertex shader
-    int attrWeights; // A handle for the "in" vec2 representing the joints weights
+    int attrJoints; // A handle for the "in" uvec4 representing the joints inflencing this vertex
+    int attrWeights; // A handle for the "in" vec4 representing the joints weights, read from unorm16
 
     int unifModel; // A handle for the "uniform" mat4 representing model matrix in the vertex shader
     int unifModelInvTr; // A handle for the "uniform" mat4 representing inverse transpose of the model matrix in the vertex shader
     int unifViewProj; // A handle for the "uniform" mat4 representing combined projection and view matrices in the vertex shader
     int unifCamPos; // A handle for the "uniform" vec4 representing color of geometry in the vertex shader
-    int unifTransformations; // A handle for the "uniform" mat4's representing overall transformations occured on this joint
-    int unifBinds; // A handle for the "uniform" mat4's representing the bind matrices of this joint
+    int unifPalette; // A handle for the "uniform" samplerBuffer holding each joint's transformation * bind matrix
+    int unifInstances; // A handle for the "uniform" samplerBuffer holding per-instance data, read by gl_InstanceID
 
 public:
     ShaderProgram(OpenGLContext* context);
@@ -40,12 +40,13 @@ public:
     void setViewProjMatrix(const glm::mat4 &vp);
     // Pass the given color to this shader on the GPU
     void setCamPos(glm::vec3 pos);
-    // Pass the given Transformation matrices to this shader on the GPU
-    void setTransformationMatrices(const std::vector<glm::mat4> &transformations);
-    // Pass the given Bind matrices to this shader on the GPU
-    void setBindMatrices(const std::vector<glm::mat4> &binds);
-    // Draw the given object to our screen using this ShaderProgram's shaders
-    void draw(Drawable &d);
+    // Tell this shader which texture unit the JointPalette is bound to
+    void setPaletteUnit(int unit);
+    // Tell this shader which texture unit its per-instance data is bound to
+    void setInstanceUnit(int unit);
+    // Draw the given object to our screen using this ShaderProgram's shaders,
+    // several times with glDrawElementsInstanced if instances is not 1
+    void draw(Drawable &d, int instances = 1);
     // Utility function used in create()
     char* textFileRead(const char*);
     // Utility function that prints any shader compilation errors to the console
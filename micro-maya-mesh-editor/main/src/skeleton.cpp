@@ -3,39 +3,35 @@
 
 Skeleton::Skeleton(OpenGLContext* context) :
     Drawable(context),
-    chosenJoint(nullptr),
+    chosenJoint(-1),
+    hierarchy(),
     joints(std::vector<uPtr<Joint>>())
 {}
 
-Joint* Skeleton::buildJoints(QJsonObject root) {
-    QString name = root["name"].toString();
-    QJsonArray pos = root["pos"].toArray();
-    QJsonArray rot = root["rot"].toArray();
-    QJsonArray children = root["children"].toArray();
+int Skeleton::buildJoints(QJsonObject root) {
+    std::vector<QString> names;
+    int first = hierarchy.size();
+    int index = SkeletonJson::read(root, hierarchy, names);
 
-    uPtr<Joint> joint = mkU<Joint>(name,
-                                   glm::vec3(pos[0].toDouble(), pos[1].toDouble(), pos[2].toDouble()),
-                                   glm::vec4(rot[0].toDouble(), rot[1].toDouble(), rot[2].toDouble(), rot[3].toDouble()));
-
-    Joint *ptr = joint.get();
-    joints.push_back(std::move(joint));
-
-    for (auto childJson : children) {
-        Joint *child = buildJoints(childJson.toObject());
-        child->parent = ptr;
-        ptr->children.push_back(child);
-        ptr->addChild(child);
+    // Parents come before children, so each joint's parent item already exists
+    for (int j = first; j < hierarchy.size(); j++) {
+        joints.push_back(mkU<Joint>(j, names[j - first]));
+        if (hierarchy.parent[j] >= 0) {
+            joints[hierarchy.parent[j]]->addChild(joints[j].get());
+        }
     }
 
-    return ptr;
+    return index;
 }
 
-std::vector<glm::mat4> Skeleton::getTransformations() {
-    std::vector<glm::mat4> transformations;
-    for (auto &joint : joints) {
-        transformations.push_back(joint->getOverallTransformation());
-    }
-    return transformations;
+void Skeleton::clear() {
+    chosenJoint = -1;
+    hierarchy.clear();
+    joints.clear();
+}
+
+const std::vector<glm::mat4> &Skeleton::getTransformations() {
+    return hierarchy.getTransformations();
 }
 
 void generateCircles(const glm::mat4& transformation, int num_segments, float radius, int idx, bool color,
@@ -88,11 +84,12 @@ void Skeleton::create() {
     int num_segments = 36;
     float radius = 0.5f;
 
-    for (auto &joint : joints) {
-        glm::mat4 transformations = joint->getOverallTransformation();
+    const std::vector<glm::mat4> &world = hierarchy.getTransformations();
+    for (int joint = 0; joint < hierarchy.size(); joint++) {
+        const glm::mat4 &transformations = world[joint];
 
         // Draw the circles
-        if (joint.get() == chosenJoint) {
+        if (joint == chosenJoint) {
             generateCircles(transformations, num_segments, radius, curIdx, false, indices, vertices, colors);
         } else {
             generateCircles(transformations, num_segments, radius, curIdx, true, indices, vertices, colors);
@@ -101,15 +98,16 @@ void Skeleton::create() {
         curIdx += 3 * num_segments;
 
         // Draw the links
-        if (joint->parent) {
+        int parent = hierarchy.parent[joint];
+        if (parent >= 0) {
             // Child joint
-            vertices.push_back(joint->getOverallTransformation() * glm::vec4(glm::vec3(), 1));
+            vertices.push_back(transformations * glm::vec4(glm::vec3(), 1));
             colors.push_back(glm::vec4(1, 1, 0, 1)); // yellow
             indices.push_back(curIdx);
             curIdx ++;
 
             // Parent joint
-            vertices.push_back(joint->parent->getOverallTransformation() * glm::vec4(glm::vec3(), 1));
+            vertices.push_back(world[parent] * glm::vec4(glm::vec3(), 1));
             colors.push_back(glm::vec4(1, 0, 1, 1)); // magenta
             indices.push_back(curIdx);
             curIdx ++;
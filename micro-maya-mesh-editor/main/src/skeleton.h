@@ -3,6 +3,8 @@
 
 #include "drawable.h"
 #include "joint.h"
+#include "jointhierarchy.h"
+#include "skeletonjson.h"
 #include "smartpointerhelp.h"
 #include <QJsonObject>
 #include <QJsonArray>
@@ -10,15 +12,24 @@
 class Skeleton : public Drawable
 {
 public:
-    Joint* chosenJoint;
+    // The index of the selected joint, -1 if none
+    int chosenJoint;
 
+    // The transformation of every joint, parents stored before their children
+    JointHierarchy hierarchy;
+
+    // The QTreeWidget entries, joints[i] is joint i of hierarchy
     std::vector<uPtr<Joint>> joints;
 
     Skeleton(OpenGLContext *context);
 
-    Joint* buildJoints(QJsonObject root);
+    // Append the joint described by root and its descendants in pre-order, returns the index of root
+    int buildJoints(QJsonObject root);
+
+    // Remove every joint
+    void clear();
 
-    std::vector<glm::mat4> getTransformations();
+    const std::vector<glm::mat4> &getTransformations();
 
     void create() override;
 
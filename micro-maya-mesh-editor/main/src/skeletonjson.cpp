@@ -0,0 +1,75 @@
+#include "skeletonjson.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include <cmath>
+
+int SkeletonJson::read(const QJsonObject &root, JointHierarchy &hierarchy, std::vector<QString> &names, int parent) {
+    QJsonArray pos = root["pos"].toArray();
+    QJsonArray rot = root["rot"].toArray();
+    QJsonArray children = root["children"].toArray();
+
+    float theta = rot[0].toDouble() / 2.f;
+    // q = [cos(theta/2), sin(theta/2)vx, sin(theta/2)vy, sin(theta/2)vz]
+    glm::quat q(cos(glm::radians(theta)),
+                sin(glm::radians(theta)) * rot[0].toDouble(),
+                sin(glm::radians(theta)) * rot[1].toDouble(),
+                sin(glm::radians(theta)) * rot[2].toDouble());
+
+    int index = hierarchy.addJoint(parent, glm::vec3(pos[0].toDouble(), pos[1].toDouble(), pos[2].toDouble()), q);
+    names.push_back(root["name"].toString());
+
+    for (auto childJson : children) {
+        read(childJson.toObject(), hierarchy, names, index);
+    }
+
+    return index;
+}
+
+bool SkeletonJson::load(const QString &path, JointHierarchy &hierarchy, std::vector<QString> &names) {
+    hierarchy.clear();
+    names.clear();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+    QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    if (!json["root"].isObject()) return false;
+
+    read(json["root"].toObject(), hierarchy, names);
+    return true;
+}
+
+bool SkeletonJson::loadClip(const QString &path, const std::vector<QString> &names, AnimationClip &clip) {
+    clip.clear();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+    QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    if (!json["tracks"].isArray()) return false;
+
+    clip.name = json["name"].toString().toStdString();
+    clip.loop = json["loop"].toBool(true);
+
+    for (auto trackValue : json["tracks"].toArray()) {
+        QJsonObject trackJson = trackValue.toObject();
+        auto joint = std::find(names.begin(), names.end(), trackJson["joint"].toString());
+        if (joint == names.end()) continue;
+        int track = clip.addTrack(joint - names.begin());
+
+        for (auto keyValue : trackJson["pos"].toArray()) {
+            QJsonArray key = keyValue.toArray();
+            clip.addPositionKey(track, key[0].toDouble(),
+                                glm::vec3(key[1].toDouble(), key[2].toDouble(), key[3].toDouble()));
+        }
+        for (auto keyValue : trackJson["rot"].toArray()) {
+            QJsonArray key = keyValue.toArray();
+            glm::vec3 axis(key[2].toDouble(), key[3].toDouble(), key[4].toDouble());
+            glm::quat rotation = glm::length(axis) > 0.f
+                    ? glm::angleAxis(glm::radians((float)key[1].toDouble()), glm::normalize(axis))
+                    : glm::quat();
+            clip.addRotationKey(track, key[0].toDouble(), rotation);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,30 @@
+#ifndef SKELETONJSON_H
+#define SKELETONJSON_H
+
+#include "animationclip.h"
+#include "jointhierarchy.h"
+#include <QJsonObject>
+#include <QString>
+#include <vector>
+
+// Reads the skeleton and animation clip .json files of the jsons folder.
+// Only depends on Qt Core so that tools without a GUI can load skeletons too.
+class SkeletonJson
+{
+public:
+    // Append the joint described by root and its descendants in pre-order, so every parent comes
+    // before its children. The name of each appended joint is appended to names. Returns the index of root.
+    static int read(const QJsonObject &root, JointHierarchy &hierarchy, std::vector<QString> &names, int parent = -1);
+
+    // Replace the content of hierarchy and names with the skeleton in the file at path.
+    // Returns false if the file cannot be read or has no "root" object.
+    static bool load(const QString &path, JointHierarchy &hierarchy, std::vector<QString> &names);
+
+    // Replace the content of clip with the clip in the file at path. Tracks name their joint, which is
+    // looked up in names, the joint names of the skeleton the clip plays on. Tracks of unknown joints are
+    // skipped. Keys are [time, x, y, z] for "pos" and [time, angle in degrees, axis x, y, z] for "rot".
+    // Returns false if the file cannot be read or has no "tracks" array.
+    static bool loadClip(const QString &path, const std::vector<QString> &names, AnimationClip &clip);
+};
+
+#endif // SKELETONJSON_H
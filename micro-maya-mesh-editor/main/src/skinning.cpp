@@ -0,0 +1,234 @@
+#include "skinning.h"
+#include "parallel.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define SKINNING_SSE
+#endif
+#include <algorithm>
+
+// Vertices blended, then transformed together by skin(DualQuat)
+static const uint32_t DUAL_QUAT_BATCH = 256;
+
+// p moved by a blend of dual quaternions, real x, y, z, w then dual x, y, z, w.
+// The blend is no longer a unit dual quaternion: both of its parts would be divided by the
+// length of the real one, instead every product of two parts is divided by its square.
+static inline glm::vec3 dualQuatTransform(const float *dq, const glm::vec3 &p) {
+    glm::vec3 real(dq[0], dq[1], dq[2]);
+    glm::vec3 dual(dq[4], dq[5], dq[6]);
+    float scale = 2.f / std::max(glm::dot(real, real) + dq[3] * dq[3], 1e-20f);
+
+    // Rotate by the real part, then translate by the vector part of dual * conjugate(real)
+    glm::vec3 rotation = glm::cross(real, glm::cross(real, p) + dq[3] * p);
+    glm::vec3 translation = dq[3] * dual - dq[7] * real + glm::cross(real, dual);
+    return p + scale * (rotation + translation);
+}
+
+void Skinning::buildPalette(const std::vector<glm::mat4> &transformations,
+                            const std::vector<glm::mat4> &binds,
+                            std::vector<glm::mat4> &palette) {
+    palette.resize(transformations.size());
+    for (size_t j = 0; j < transformations.size(); j++) {
+        palette[j] = transformations[j] * binds[j];
+    }
+}
+
+void Skinning::buildDualQuatPalette(const std::vector<glm::mat4> &transformations,
+                                    const std::vector<glm::mat4> &binds,
+                                    std::vector<DualQuat> &palette) {
+    palette.resize(transformations.size());
+    for (size_t j = 0; j < transformations.size(); j++) {
+        glm::mat4 matrix = transformations[j] * binds[j];
+        glm::vec3 translation(matrix[3]);
+        DualQuat &dq = palette[j];
+        dq.real = glm::normalize(glm::quat_cast(glm::mat3(matrix)));
+        dq.dual = glm::quat(0.f, translation.x, translation.y, translation.z) * dq.real * 0.5f;
+    }
+}
+
+// Linear blend skinning of one vertex of rest into posed
+static inline void skinLinear(const HalfEdgeMesh &rest, const std::vector<glm::mat4> &palette,
+                              uint32_t vert, HalfEdgeMesh &posed) {
+    const int numJoints = palette.size();
+
+    const SkinInfluences &skin = rest.vertSkin[vert];
+    float x = rest.posX[vert];
+    float y = rest.posY[vert];
+    float z = rest.posZ[vert];
+    if (skin.empty()) {
+        posed.posX[vert] = x;
+        posed.posY[vert] = y;
+        posed.posZ[vert] = z;
+        return;
+    }
+
+#ifdef SKINNING_SSE
+    // Blend the columns of the palette matrices, then transform the point once
+    __m128 col0 = _mm_setzero_ps();
+    __m128 col1 = _mm_setzero_ps();
+    __m128 col2 = _mm_setzero_ps();
+    __m128 col3 = _mm_setzero_ps();
+    for (int i = 0; i < SkinInfluences::MAX && skin.weight[i] > 0; i++) {
+        if (skin.joint[i] >= numJoints) continue;
+        const float *m = &palette[skin.joint[i]][0][0];
+        __m128 w = _mm_set1_ps(skin.weightf(i));
+        col0 = _mm_add_ps(col0, _mm_mul_ps(w, _mm_loadu_ps(m)));
+        col1 = _mm_add_ps(col1, _mm_mul_ps(w, _mm_loadu_ps(m + 4)));
+        col2 = _mm_add_ps(col2, _mm_mul_ps(w, _mm_loadu_ps(m + 8)));
+        col3 = _mm_add_ps(col3, _mm_mul_ps(w, _mm_loadu_ps(m + 12)));
+    }
+    __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(x)), _mm_mul_ps(col1, _mm_set1_ps(y))),
+                          _mm_add_ps(_mm_mul_ps(col2, _mm_set1_ps(z)), col3));
+    alignas(16) float out[4];
+    _mm_store_ps(out, p);
+    posed.posX[vert] = out[0];
+    posed.posY[vert] = out[1];
+    posed.posZ[vert] = out[2];
+#else
+    glm::mat4 blended(0.f);
+    for (int i = 0; i < SkinInfluences::MAX && skin.weight[i] > 0; i++) {
+        if (skin.joint[i] >= numJoints) continue;
+        blended += palette[skin.joint[i]] * skin.weightf(i);
+    }
+    glm::vec4 p = blended * glm::vec4(x, y, z, 1.f);
+    posed.posX[vert] = p.x;
+    posed.posY[vert] = p.y;
+    posed.posZ[vert] = p.z;
+#endif
+}
+
+void Skinning::skin(const HalfEdgeMesh &rest, const std::vector<glm::mat4> &palette, HalfEdgeMesh &posed) {
+    parallelFor(0, rest.numVerts(), [&](uint32_t vert) {
+        skinLinear(rest, palette, vert, posed);
+    }, 1024);
+}
+
+void Skinning::skinVertices(const HalfEdgeMesh &rest, const std::vector<glm::mat4> &palette,
+                            const std::vector<uint32_t> &verts, HalfEdgeMesh &posed) {
+    for (uint32_t vert : verts) {
+        skinLinear(rest, palette, vert, posed);
+    }
+}
+
+// The blend of the dual quaternions that influence a vertex, real x, y, z, w then dual x, y, z, w
+static inline void blendDualQuats(const SkinInfluences &skin, const std::vector<DualQuat> &palette, float *out) {
+    const int numJoints = palette.size();
+
+    // q and -q are the same rotation but would cancel out when blended, so every influence
+    // is flipped to the side of the first one. Unbound vertices get the identity.
+    const glm::quat *pivot = nullptr;
+#ifdef SKINNING_SSE
+    __m128 real = _mm_setzero_ps();
+    __m128 dual = _mm_setzero_ps();
+    for (int k = 0; k < SkinInfluences::MAX && skin.weight[k] > 0; k++) {
+        if (skin.joint[k] >= numJoints) continue;
+        const DualQuat &dq = palette[skin.joint[k]];
+        if (!pivot) pivot = &dq.real;
+        float weight = glm::dot(*pivot, dq.real) < 0.f ? -skin.weightf(k) : skin.weightf(k);
+        __m128 w = _mm_set1_ps(weight);
+        real = _mm_add_ps(real, _mm_mul_ps(w, _mm_loadu_ps(&dq.real.x)));
+        dual = _mm_add_ps(dual, _mm_mul_ps(w, _mm_loadu_ps(&dq.dual.x)));
+    }
+    if (!pivot) real = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+    _mm_store_ps(out, real);
+    _mm_store_ps(out + 4, dual);
+#else
+    std::fill(out, out + 8, 0.f);
+    for (int k = 0; k < SkinInfluences::MAX && skin.weight[k] > 0; k++) {
+        if (skin.joint[k] >= numJoints) continue;
+        const DualQuat &dq = palette[skin.joint[k]];
+        if (!pivot) pivot = &dq.real;
+        float weight = glm::dot(*pivot, dq.real) < 0.f ? -skin.weightf(k) : skin.weightf(k);
+        const float *r = &dq.real.x;
+        const float *d = &dq.dual.x;
+        for (int c = 0; c < 4; c++) {
+            out[c] += weight * r[c];
+            out[4 + c] += weight * d[c];
+        }
+    }
+    if (!pivot) out[3] = 1.f;
+#endif
+}
+
+void Skinning::skin(const HalfEdgeMesh &rest, const std::vector<DualQuat> &palette, HalfEdgeMesh &posed) {
+    const uint32_t numVerts = rest.numVerts();
+    const uint32_t numBatches = (numVerts + DUAL_QUAT_BATCH - 1) / DUAL_QUAT_BATCH;
+
+    parallelFor(0, numBatches, [&](uint32_t batch) {
+        const uint32_t first = batch * DUAL_QUAT_BATCH;
+        const uint32_t count = std::min(DUAL_QUAT_BATCH, numVerts - first);
+
+        // The blend of every vertex in the batch, real x, y, z, w then dual x, y, z, w
+        alignas(16) float blended[DUAL_QUAT_BATCH * 8];
+
+        for (uint32_t i = 0; i < count; i++) {
+            blendDualQuats(rest.vertSkin[first + i], palette, blended + i * 8);
+        }
+
+        const float *restX = &rest.posX[first], *restY = &rest.posY[first], *restZ = &rest.posZ[first];
+        float *posedX = &posed.posX[first], *posedY = &posed.posY[first], *posedZ = &posed.posZ[first];
+        uint32_t i = 0;
+#ifdef SKINNING_SSE
+        // Four vertices at a time, with their blends transposed to one register per component
+        for (; i + 4 <= count; i += 4) {
+            const float *dq = blended + i * 8;
+            __m128 rx = _mm_load_ps(dq), ry = _mm_load_ps(dq + 8);
+            __m128 rz = _mm_load_ps(dq + 16), rw = _mm_load_ps(dq + 24);
+            __m128 dx = _mm_load_ps(dq + 4), dy = _mm_load_ps(dq + 12);
+            __m128 dz = _mm_load_ps(dq + 20), dw = _mm_load_ps(dq + 28);
+            _MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+            _MM_TRANSPOSE4_PS(dx, dy, dz, dw);
+            __m128 x = _mm_loadu_ps(restX + i), y = _mm_loadu_ps(restY + i), z = _mm_loadu_ps(restZ + i);
+
+            __m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)),
+                                        _mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw)));
+            __m128 scale = _mm_div_ps(_mm_set1_ps(2.f), _mm_max_ps(length2, _mm_set1_ps(1e-20f)));
+
+            __m128 cx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(ry, z), _mm_mul_ps(rz, y)), _mm_mul_ps(rw, x));
+            __m128 cy = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rz, x), _mm_mul_ps(rx, z)), _mm_mul_ps(rw, y));
+            __m128 cz = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rx, y), _mm_mul_ps(ry, x)), _mm_mul_ps(rw, z));
+            __m128 tx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dx), _mm_mul_ps(dw, rx)),
+                                   _mm_sub_ps(_mm_mul_ps(ry, dz), _mm_mul_ps(rz, dy)));
+            __m128 ty = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dy), _mm_mul_ps(dw, ry)),
+                                   _mm_sub_ps(_mm_mul_ps(rz, dx), _mm_mul_ps(rx, dz)));
+            __m128 tz = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, dz), _mm_mul_ps(dw, rz)),
+                                   _mm_sub_ps(_mm_mul_ps(rx, dy), _mm_mul_ps(ry, dx)));
+            tx = _mm_add_ps(tx, _mm_sub_ps(_mm_mul_ps(ry, cz), _mm_mul_ps(rz, cy)));
+            ty = _mm_add_ps(ty, _mm_sub_ps(_mm_mul_ps(rz, cx), _mm_mul_ps(rx, cz)));
+            tz = _mm_add_ps(tz, _mm_sub_ps(_mm_mul_ps(rx, cy), _mm_mul_ps(ry, cx)));
+
+            _mm_storeu_ps(posedX + i, _mm_add_ps(x, _mm_mul_ps(scale, tx)));
+            _mm_storeu_ps(posedY + i, _mm_add_ps(y, _mm_mul_ps(scale, ty)));
+            _mm_storeu_ps(posedZ + i, _mm_add_ps(z, _mm_mul_ps(scale, tz)));
+        }
+#endif
+        for (; i < count; i++) {
+            glm::vec3 p = dualQuatTransform(blended + i * 8, glm::vec3(restX[i], restY[i], restZ[i]));
+            posedX[i] = p.x;
+            posedY[i] = p.y;
+            posedZ[i] = p.z;
+        }
+    }, 1);
+}
+
+void Skinning::skinVertices(const HalfEdgeMesh &rest, const std::vector<DualQuat> &palette,
+                            const std::vector<uint32_t> &verts, HalfEdgeMesh &posed) {
+    for (uint32_t vert : verts) {
+        alignas(16) float blended[8];
+        blendDualQuats(rest.vertSkin[vert], palette, blended);
+        posed.setPosition(vert, dualQuatTransform(blended, rest.position(vert)));
+    }
+}
+
+void Skinning::pose(const HalfEdgeMesh &rest, const std::vector<glm::mat4> &transformations,
+                    const std::vector<glm::mat4> &binds, HalfEdgeMesh &posed) {
+    if (rest.skinningMethod == DUAL_QUATERNION) {
+        std::vector<DualQuat> palette;
+        buildDualQuatPalette(transformations, binds, palette);
+        skin(rest, palette, posed);
+    } else {
+        std::vector<glm::mat4> palette;
+        buildPalette(transformations, binds, palette);
+        skin(rest, palette, posed);
+    }
+}
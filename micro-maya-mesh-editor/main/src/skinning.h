@@ -0,0 +1,52 @@
+#ifndef SKINNING_H
+#define SKINNING_H
+
+#include "halfedgemesh.h"
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+// A rigid transformation as a unit dual quaternion real + e * dual, where real is the rotation and
+// dual = 0.5 * translation * real. Two RGBA32F texels on the GPU, half the size of a palette matrix.
+struct DualQuat
+{
+    glm::quat real;
+    glm::quat dual;
+};
+
+// Skinning on the CPU, the same deformations skeleton.vert.glsl and skeleton_dq.vert.glsl apply on the GPU.
+// Linear blend skinning moves each vertex by the weighted sum of its joints' palette matrices. The
+// matrices are blended four floats at a time with SSE when available.
+// Dual quaternion skinning blends 8 floats per influence instead of 16, then normalizes the result
+// so that it stays a rotation and a translation, which keeps the volume of twisted joints.
+// Vertices are split in batches over threads.
+class Skinning
+{
+public:
+    // palette[j] = transformations[j] * binds[j], the matrix taking a rest position to joint j's posed frame
+    static void buildPalette(const std::vector<glm::mat4> &transformations,
+                             const std::vector<glm::mat4> &binds,
+                             std::vector<glm::mat4> &palette);
+
+    // The same transformations as buildPalette, as dual quaternions. Joints must not be scaled.
+    static void buildDualQuatPalette(const std::vector<glm::mat4> &transformations,
+                                     const std::vector<glm::mat4> &binds,
+                                     std::vector<DualQuat> &palette);
+
+    // Write to posed the positions of rest's vertices deformed by palette.
+    // posed must have as many vertices as rest, vertices bound to no joint keep their rest position.
+    static void skin(const HalfEdgeMesh &rest, const std::vector<glm::mat4> &palette, HalfEdgeMesh &posed);
+    static void skin(const HalfEdgeMesh &rest, const std::vector<DualQuat> &palette, HalfEdgeMesh &posed);
+
+    // skin for the given vertices only, for edits that move a few of them. posed must have as many
+    // vertices as rest, the other vertices are left as they are.
+    static void skinVertices(const HalfEdgeMesh &rest, const std::vector<glm::mat4> &palette,
+                             const std::vector<uint32_t> &verts, HalfEdgeMesh &posed);
+    static void skinVertices(const HalfEdgeMesh &rest, const std::vector<DualQuat> &palette,
+                             const std::vector<uint32_t> &verts, HalfEdgeMesh &posed);
+
+    // Build the palette of rest.skinningMethod and skin rest with it
+    static void pose(const HalfEdgeMesh &rest, const std::vector<glm::mat4> &transformations,
+                     const std::vector<glm::mat4> &binds, HalfEdgeMesh &posed);
+};
+
+#endif // SKINNING_H
@@ -2,45 +2,74 @@ INCLUDEPATH += $$PWD
 DEPENDPATH += $$PWD
 
 SOURCES += \
-    $$PWD/face.cpp \
+    $$PWD/animationclip.cpp \
+    $$PWD/facebvh.cpp \
     $$PWD/facedisplay.cpp \
-    $$PWD/halfedge.cpp \
     $$PWD/halfedgedisplay.cpp \
+    $$PWD/halfedgemesh.cpp \
     $$PWD/joint.cpp \
+    $$PWD/jointgizmos.cpp \
+    $$PWD/jointhierarchy.cpp \
+    $$PWD/jointpalette.cpp \
+    $$PWD/kdtree.cpp \
     $$PWD/main.cpp \
     $$PWD/mainwindow.cpp \
     $$PWD/mesh.cpp \
+    $$PWD/meshbuffers.cpp \
+    $$PWD/meshhistory.cpp \
+    $$PWD/meshwriter.cpp \
     $$PWD/mygl.cpp \
+    $$PWD/objloader.cpp \
     $$PWD/shaderprogram.cpp \
     $$PWD/skeleton.cpp \
+    $$PWD/skeletonjson.cpp \
+    $$PWD/skinning.cpp \
+    $$PWD/subdivision.cpp \
+    $$PWD/triangulation.cpp \
     $$PWD/utils.cpp \
     $$PWD/la.cpp \
+    $$PWD/decimation.cpp \
     $$PWD/drawable.cpp \
     $$PWD/camera.cpp \
     $$PWD/cameracontrolshelp.cpp \
+    $$PWD/componentlistmodel.cpp \
     $$PWD/openglcontext.cpp \
     $$PWD/scene/squareplane.cpp \
-    $$PWD/vertex.cpp \
     $$PWD/vertexdisplay.cpp
 
 HEADERS += \
-    $$PWD/face.h \
+    $$PWD/animationclip.h \
+    $$PWD/decimation.h \
+    $$PWD/facebvh.h \
     $$PWD/facedisplay.h \
-    $$PWD/halfedge.h \
     $$PWD/halfedgedisplay.h \
+    $$PWD/halfedgemesh.h \
     $$PWD/joint.h \
+    $$PWD/jointgizmos.h \
+    $$PWD/jointhierarchy.h \
+    $$PWD/jointpalette.h \
+    $$PWD/kdtree.h \
     $$PWD/la.h \
     $$PWD/mainwindow.h \
     $$PWD/mesh.h \
+    $$PWD/meshbuffers.h \
+    $$PWD/meshhistory.h \
+    $$PWD/meshwriter.h \
     $$PWD/mygl.h \
+    $$PWD/objloader.h \
+    $$PWD/parallel.h \
     $$PWD/shaderprogram.h \
     $$PWD/skeleton.h \
+    $$PWD/skeletonjson.h \
+    $$PWD/skinning.h \
+    $$PWD/subdivision.h \
+    $$PWD/triangulation.h \
     $$PWD/utils.h \
     $$PWD/drawable.h \
     $$PWD/camera.h \
     $$PWD/cameracontrolshelp.h \
+    $$PWD/componentlistmodel.h \
     $$PWD/openglcontext.h \
     $$PWD/scene/squareplane.h\
     $$PWD/smartpointerhelp.h \
-    $$PWD/vertex.h \
     $$PWD/vertexdisplay.h
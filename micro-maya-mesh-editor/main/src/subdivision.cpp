@@ -0,0 +1,402 @@
+#include "subdivision.h"
+#include "parallel.h"
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+void Subdivision::catmullClark(HalfEdgeMesh &mesh, int levels) {
+    if (levels <= 0) return;
+
+    // The two meshes take turns being the coarse and the fine one, so both get the capacity of
+    // the last level up front instead of growing, and copying stale content, at every level
+    uint32_t verts, halfEdges, faces;
+    predictCounts(mesh, levels, verts, halfEdges, faces);
+    HalfEdgeMesh fine;
+    fine.reserve(verts, halfEdges, faces);
+    if (levels > 1) mesh.reserve(verts, halfEdges, faces);
+
+    std::vector<uint32_t> edgeOf;
+    edgeOf.reserve(halfEdges / 4);
+    for (int i = 0; i < levels; i++) {
+        refine(mesh, fine, edgeOf);
+        std::swap(mesh, fine);
+    }
+}
+
+void Subdivision::catmullClark(HalfEdgeMesh &mesh, std::vector<uint32_t> &faces, int levels) {
+    for (int i = 0; i < levels; i++) {
+        refineRegion(mesh, faces);
+    }
+}
+
+void Subdivision::predictCounts(const HalfEdgeMesh &mesh, int levels,
+                                uint32_t &verts, uint32_t &halfEdges, uint32_t &faces) {
+    uint64_t v = mesh.numVerts();
+    uint64_t h = mesh.numHalfEdges();
+    uint64_t f = mesh.numFaces();
+    uint64_t e = 0;
+    for (uint32_t i = 0; i < mesh.numHalfEdges(); i++) {
+        if (mesh.heSym[i] == NO_INDEX || i < mesh.heSym[i]) e++;
+    }
+
+    for (int level = 0; level < levels; level++) {
+        // Every edge is split in two, and every HalfEdge adds the edge from its edge point to its face point
+        uint64_t nextE = 2 * e + h;
+        v = v + f + e;
+        f = h;
+        h = 4 * h;
+        e = nextE;
+    }
+    verts = v;
+    halfEdges = h;
+    faces = f;
+}
+
+void Subdivision::refine(const HalfEdgeMesh &coarse, HalfEdgeMesh &fine) {
+    std::vector<uint32_t> edgeOf;
+    refine(coarse, fine, edgeOf);
+}
+
+void Subdivision::refine(const HalfEdgeMesh &coarse, HalfEdgeMesh &fine, std::vector<uint32_t> &edgeOf) {
+    const uint32_t numVerts = coarse.numVerts();
+    const uint32_t numHalfEdges = coarse.numHalfEdges();
+    const uint32_t numFaces = coarse.numFaces();
+
+    // Number the undirected edges. A HalfEdge owns its edge if it has no sym or the smaller index.
+    edgeOf.resize(numHalfEdges);
+    uint32_t numEdges = 0;
+    for (uint32_t h = 0; h < numHalfEdges; h++) {
+        uint32_t sym = coarse.heSym[h];
+        if (sym == NO_INDEX || h < sym) edgeOf[h] = numEdges++;
+    }
+    parallelFor(0, numHalfEdges, [&](uint32_t h) {
+        uint32_t sym = coarse.heSym[h];
+        if (sym != NO_INDEX && sym < h) edgeOf[h] = edgeOf[sym];
+    });
+
+    const uint32_t facePoint = numVerts;
+    const uint32_t edgePoint = numVerts + numFaces;
+    // New points of a bound mesh blend the influences of the vertices they lie between
+    const bool bound = numVerts > 0 && !coarse.vertSkin[0].empty();
+
+    fine.heNext.resize(4 * numHalfEdges);
+    fine.heSym.assign(4 * numHalfEdges, NO_INDEX);
+    fine.heFace.resize(4 * numHalfEdges);
+    fine.heVert.resize(4 * numHalfEdges);
+    fine.posX.resize(edgePoint + numEdges);
+    fine.posY.resize(edgePoint + numEdges);
+    fine.posZ.resize(edgePoint + numEdges);
+    fine.vertEdge.resize(edgePoint + numEdges);
+    fine.vertSkin.assign(edgePoint + numEdges, SkinInfluences());
+    fine.faceEdge.resize(numHalfEdges);
+    fine.faceColor.resize(numHalfEdges);
+    // Not an element array, but fine replaces coarse and must be skinned the same way
+    fine.skinningMethod = coarse.skinningMethod;
+
+    /*
+        The quad of HalfEdge h, where b is the vertex h points to and n = next(h)
+
+            E(h)---4h+0--->b
+             ^             |
+           4h+3          4h+1
+             |             v
+             F<---4h+2---E(n)
+    */
+    parallelFor(0, numHalfEdges, [&](uint32_t h) {
+        uint32_t n = coarse.heNext[h];
+        uint32_t face = coarse.heFace[h];
+        uint32_t child = 4 * h;
+
+        fine.heVert[child + 0] = coarse.heVert[h];
+        fine.heVert[child + 1] = edgePoint + edgeOf[n];
+        fine.heVert[child + 2] = facePoint + face;
+        fine.heVert[child + 3] = edgePoint + edgeOf[h];
+        for (uint32_t k = 0; k < 4; k++) {
+            fine.heNext[child + k] = child + (k + 1) % 4;
+            fine.heFace[child + k] = h;
+        }
+
+        // b -> E(n) runs against E(n) -> b in the quad of sym(n),
+        // E(n) -> F runs against F -> E(n) in the quad of n.
+        // Each sym slot is written by exactly one HalfEdge.
+        uint32_t symN = coarse.heSym[n];
+        if (symN != NO_INDEX) {
+            fine.heSym[child + 1] = 4 * symN + 0;
+            fine.heSym[4 * symN + 0] = child + 1;
+        }
+        fine.heSym[child + 2] = 4 * n + 3;
+        fine.heSym[4 * n + 3] = child + 2;
+
+        fine.faceEdge[h] = child;
+        fine.faceColor[h] = coarse.faceColor[face];
+
+        if (coarse.heSym[h] == NO_INDEX || h < coarse.heSym[h]) {
+            fine.vertEdge[edgePoint + edgeOf[h]] = child + 3;
+        }
+    });
+
+    // Face points: the centroid of each Face
+    parallelFor(0, numFaces, [&](uint32_t f) {
+        glm::vec3 centroid(0.f);
+        int numEdges = 0;
+        SkinBlend blend;
+        uint32_t edge = coarse.faceEdge[f];
+        do {
+            centroid += coarse.position(coarse.heVert[edge]);
+            if (bound) blend.add(coarse.vertSkin[coarse.heVert[edge]]);
+            edge = coarse.heNext[edge];
+            numEdges++;
+        } while (edge != coarse.faceEdge[f]);
+
+        fine.setPosition(facePoint + f, centroid / (float)numEdges);
+        if (bound) fine.vertSkin[facePoint + f] = blend.result();
+        fine.vertEdge[facePoint + f] = 4 * coarse.faceEdge[f] + 2;
+    });
+
+    // Edge points: the average of both endpoints and both adjacent face points,
+    // or the plain midpoint on a boundary
+    parallelFor(0, numHalfEdges, [&](uint32_t h) {
+        uint32_t sym = coarse.heSym[h];
+        if (sym != NO_INDEX && sym < h) return;
+
+        glm::vec3 pos;
+        if (sym != NO_INDEX) {
+            pos = (coarse.position(coarse.heVert[h]) + coarse.position(coarse.heVert[sym]) +
+                   fine.position(facePoint + coarse.heFace[h]) + fine.position(facePoint + coarse.heFace[sym])) / 4.f;
+        } else {
+            pos = (coarse.position(coarse.heVert[h]) + coarse.position(coarse.heVert[coarse.prevHalfEdge(h)])) / 2.f;
+        }
+        fine.setPosition(edgePoint + edgeOf[h], pos);
+
+        if (bound) {
+            SkinBlend blend;
+            blend.add(coarse.vertSkin[coarse.heVert[h]]);
+            blend.add(coarse.vertSkin[sym != NO_INDEX ? coarse.heVert[sym] : coarse.heVert[coarse.prevHalfEdge(h)]]);
+            fine.vertSkin[edgePoint + edgeOf[h]] = blend.result();
+        }
+    });
+
+    // Vertex points: v' = (n-2)v/n + sum(e)/n^2 + sum(f)/n^2 over the adjacent edge and face points.
+    // Boundary vertices keep their position.
+    parallelFor(0, numVerts, [&](uint32_t v) {
+        glm::vec3 pos = coarse.position(v);
+        uint32_t start = coarse.vertEdge[v];
+        fine.vertSkin[v] = coarse.vertSkin[v];
+
+        if (start == NO_INDEX) {
+            fine.setPosition(v, pos);
+            fine.vertEdge[v] = NO_INDEX;
+            return;
+        }
+        fine.vertEdge[v] = 4 * start + 0;
+
+        float n = 0.f;
+        glm::vec3 e(0.f);
+        glm::vec3 f(0.f);
+        uint32_t edge = start;
+        do {
+            uint32_t sym = coarse.heSym[coarse.heNext[edge]];
+            if (coarse.heSym[edge] == NO_INDEX || sym == NO_INDEX) {
+                fine.setPosition(v, pos);
+                return;
+            }
+            e += fine.position(edgePoint + edgeOf[edge]);
+            f += fine.position(facePoint + coarse.heFace[edge]);
+            edge = sym;
+            n += 1.f;
+        } while (edge != start);
+
+        fine.setPosition(v, (n - 2) * pos / n + e / (n * n) + f / (n * n));
+    });
+}
+
+void Subdivision::refineRegion(HalfEdgeMesh &mesh, std::vector<uint32_t> &faces) {
+    std::sort(faces.begin(), faces.end());
+    faces.erase(std::unique(faces.begin(), faces.end()), faces.end());
+    faces.erase(std::lower_bound(faces.begin(), faces.end(), mesh.numFaces()), faces.end());
+    if (faces.empty()) return;
+
+    auto regionIndex = [&](uint32_t face) {
+        auto it = std::lower_bound(faces.begin(), faces.end(), face);
+        return it != faces.end() && *it == face ? uint32_t(it - faces.begin()) : NO_INDEX;
+    };
+    auto inRegion = [&](uint32_t face) {
+        return face != NO_INDEX && regionIndex(face) != NO_INDEX;
+    };
+
+    // The HalfEdges of the region face by face, those of faces[i] starting at faceStart[i]
+    std::vector<uint32_t> edges;
+    std::vector<uint32_t> faceStart;
+    std::vector<glm::vec3> facePos;
+    std::vector<SkinInfluences> faceSkin;
+    const bool bound = !mesh.vertSkin[0].empty();
+    for (uint32_t face : faces) {
+        faceStart.push_back(edges.size());
+        glm::vec3 centroid(0.f);
+        SkinBlend blend;
+        uint32_t edge = mesh.faceEdge[face];
+        do {
+            edges.push_back(edge);
+            centroid += mesh.position(mesh.heVert[edge]);
+            if (bound) blend.add(mesh.vertSkin[mesh.heVert[edge]]);
+            edge = mesh.heNext[edge];
+        } while (edge != mesh.faceEdge[face]);
+        facePos.push_back(centroid / float(edges.size() - faceStart.back()));
+        faceSkin.push_back(bound ? blend.result() : SkinInfluences());
+    }
+    faceStart.push_back(edges.size());
+
+    // Edge points, one per undirected edge of the region, found from either of its HalfEdges.
+    // Across the border the Face on the other side stays as it is, so the edge point is the midpoint.
+    std::unordered_map<uint32_t, uint32_t> edgePointOf;
+    std::vector<glm::vec3> edgePos;
+    std::vector<SkinInfluences> edgeSkin;
+    for (uint32_t h : edges) {
+        if (edgePointOf.count(h)) continue;
+        uint32_t sym = mesh.heSym[h];
+        uint32_t from = sym != NO_INDEX ? mesh.heVert[sym] : mesh.heVert[mesh.prevHalfEdge(h)];
+        glm::vec3 a = mesh.position(from);
+        glm::vec3 b = mesh.position(mesh.heVert[h]);
+        SkinBlend blend;
+        if (bound) {
+            blend.add(mesh.vertSkin[from]);
+            blend.add(mesh.vertSkin[mesh.heVert[h]]);
+        }
+        edgeSkin.push_back(bound ? blend.result() : SkinInfluences());
+        if (sym != NO_INDEX && inRegion(mesh.heFace[sym])) {
+            edgePos.push_back((a + b + facePos[regionIndex(mesh.heFace[h])] + facePos[regionIndex(mesh.heFace[sym])]) / 4.f);
+        } else {
+            edgePos.push_back((a + b) / 2.f);
+        }
+        edgePointOf[h] = edgePos.size() - 1;
+        if (sym != NO_INDEX) edgePointOf[sym] = edgePos.size() - 1;
+    }
+
+    // Vertex points, by the same rule as refine for vertices surrounded by the region.
+    // Vertices on the border or on a boundary do not move.
+    std::vector<uint32_t> verts;
+    for (uint32_t h : edges) verts.push_back(mesh.heVert[h]);
+    std::sort(verts.begin(), verts.end());
+    verts.erase(std::unique(verts.begin(), verts.end()), verts.end());
+    std::vector<glm::vec3> vertPos(verts.size());
+    for (size_t i = 0; i < verts.size(); i++) {
+        uint32_t v = verts[i];
+        glm::vec3 pos = mesh.position(v);
+        vertPos[i] = pos;
+
+        float n = 0.f;
+        glm::vec3 e(0.f);
+        glm::vec3 f(0.f);
+        uint32_t start = mesh.vertEdge[v];
+        uint32_t edge = start;
+        bool interior = true;
+        do {
+            uint32_t sym = mesh.heSym[mesh.heNext[edge]];
+            if (mesh.heSym[edge] == NO_INDEX || sym == NO_INDEX || !inRegion(mesh.heFace[edge])) {
+                interior = false;
+                break;
+            }
+            e += edgePos[edgePointOf.at(edge)];
+            f += facePos[regionIndex(mesh.heFace[edge])];
+            edge = sym;
+            n += 1.f;
+        } while (edge != start);
+
+        if (interior) vertPos[i] = (n - 2) * pos / n + e / (n * n) + f / (n * n);
+    }
+
+    // The syms of the region and the HalfEdges across the border with the HalfEdge before each
+    // in its Face, taken before any of them is rewired
+    std::vector<uint32_t> syms;
+    std::vector<std::pair<uint32_t, uint32_t>> across;
+    for (uint32_t h : edges) {
+        uint32_t sym = mesh.heSym[h];
+        syms.push_back(sym);
+        if (sym != NO_INDEX && !inRegion(mesh.heFace[sym])) across.emplace_back(sym, mesh.prevHalfEdge(sym));
+    }
+
+    const uint32_t numRegionEdges = edges.size();
+    const uint32_t numRegionFaces = faces.size();
+    const uint32_t facePoint = mesh.numVerts();
+    const uint32_t edgePoint = facePoint + numRegionFaces;
+    const uint32_t firstHalfEdge = mesh.numHalfEdges();
+    const uint32_t innerHalfEdge = firstHalfEdge + numRegionEdges + across.size();
+    const uint32_t firstFace = mesh.numFaces();
+
+    for (uint32_t i = 0; i < numRegionFaces; i++) mesh.vertSkin[mesh.addVertex(facePos[i])] = faceSkin[i];
+    for (size_t i = 0; i < edgePos.size(); i++) mesh.vertSkin[mesh.addVertex(edgePos[i])] = edgeSkin[i];
+    for (uint32_t i = firstHalfEdge; i < innerHalfEdge + 2 * numRegionEdges; i++) mesh.addHalfEdge();
+
+    // Every split HalfEdge a->b keeps its index for the half E->b and gains a new one for a->E
+    std::unordered_map<uint32_t, uint32_t> firstHalf;
+    for (uint32_t j = 0; j < numRegionEdges; j++) firstHalf[edges[j]] = firstHalfEdge + j;
+    for (uint32_t k = 0; k < across.size(); k++) firstHalf[across[k].first] = firstHalfEdge + numRegionEdges + k;
+
+    /*
+        The quad of the region HalfEdge h = edges[j] pointing to b, with n = next(h),
+        c = innerHalfEdge + 2j and d = c + 1. The first quad of a Face keeps the Face's index.
+
+            E(h)----h----->b
+             ^             |
+             d         first(n)
+             |             v
+             F<-----c----E(n)
+    */
+    for (uint32_t i = 0; i < numRegionFaces; i++) {
+        uint32_t begin = faceStart[i];
+        uint32_t end = faceStart[i + 1];
+        for (uint32_t j = begin; j < end; j++) {
+            uint32_t nj = j + 1 < end ? j + 1 : begin;
+            uint32_t h = edges[j];
+            uint32_t n = edges[nj];
+            uint32_t c = innerHalfEdge + 2 * j;
+            uint32_t d = c + 1;
+            uint32_t quad = j == begin ? faces[i] : mesh.addFace(mesh.faceColor[faces[i]]);
+
+            mesh.heNext[h] = firstHalf[n];
+            mesh.heNext[firstHalf[n]] = c;
+            mesh.heNext[c] = d;
+            mesh.heNext[d] = h;
+            mesh.heFace[h] = quad;
+            mesh.heFace[firstHalf[n]] = quad;
+            mesh.heFace[c] = quad;
+            mesh.heFace[d] = quad;
+            mesh.heVert[firstHalf[h]] = edgePoint + edgePointOf[h];
+            mesh.heVert[c] = facePoint + i;
+            mesh.heVert[d] = edgePoint + edgePointOf[h];
+            mesh.faceEdge[quad] = h;
+
+            // E(n) -> F runs against F -> E(n) in the quad of n
+            mesh.heSym[c] = innerHalfEdge + 2 * nj + 1;
+            mesh.heSym[innerHalfEdge + 2 * nj + 1] = c;
+
+            // a -> E runs against E -> a, and E -> b against b -> E
+            uint32_t sym = syms[j];
+            if (sym != NO_INDEX) {
+                mesh.heSym[firstHalf[h]] = sym;
+                mesh.heSym[firstHalf[sym]] = h;
+                mesh.heSym[h] = firstHalf[sym];
+                mesh.heSym[sym] = firstHalf[h];
+            }
+
+            mesh.vertEdge[edgePoint + edgePointOf[h]] = firstHalf[h];
+            mesh.vertEdge[facePoint + i] = c;
+        }
+    }
+
+    // Insert the edge points into the Faces across the border
+    for (const auto &pair : across) {
+        uint32_t sym = pair.first;
+        uint32_t first = firstHalf[sym];
+        mesh.heNext[pair.second] = first;
+        mesh.heNext[first] = sym;
+        mesh.heFace[first] = mesh.heFace[sym];
+        mesh.heVert[first] = edgePoint + edgePointOf[sym];
+    }
+
+    for (size_t i = 0; i < verts.size(); i++) {
+        mesh.setPosition(verts[i], vertPos[i]);
+    }
+
+    for (uint32_t face = firstFace; face < mesh.numFaces(); face++) faces.push_back(face);
+}
@@ -0,0 +1,40 @@
+#ifndef SUBDIVISION_H
+#define SUBDIVISION_H
+
+#include "halfedgemesh.h"
+
+// Catmull-Clark subdivision whose refined topology follows from index arithmetic alone.
+// Every HalfEdge h of the coarse mesh becomes the quad Face h made of the HalfEdges 4h..4h+3,
+// and the refined vertices are laid out as [original vertices, face points, edge points].
+// Since no element depends on another one of its kind, each pass runs in parallel.
+class Subdivision
+{
+public:
+    // Replace mesh by its refinement after the given number of levels
+    static void catmullClark(HalfEdgeMesh &mesh, int levels);
+
+    // One level of refinement from coarse into fine. fine's previous content is discarded.
+    static void refine(const HalfEdgeMesh &coarse, HalfEdgeMesh &fine);
+
+    // Refine only the given Faces of mesh, in place, the given number of levels. faces is replaced by
+    // the Faces of the refined region, so the next level or a later call refines it further.
+    static void catmullClark(HalfEdgeMesh &mesh, std::vector<uint32_t> &faces, int levels);
+
+    // The exact element counts of mesh after the given number of levels
+    static void predictCounts(const HalfEdgeMesh &mesh, int levels,
+                              uint32_t &verts, uint32_t &halfEdges, uint32_t &faces);
+
+private:
+    // One level of catmullClark on a region. Region Faces are split into quads as by refine, and
+    // the edge points on the region's border are inserted into the Faces across it, which keeps
+    // the mesh manifold without touching those Faces' shape. The border is held in place like a
+    // mesh boundary: its edge points are midpoints and its vertices do not move.
+    // Only appends elements and rewrites those of the region and its border,
+    // so the cost follows the size of the region rather than of the mesh.
+    static void refineRegion(HalfEdgeMesh &mesh, std::vector<uint32_t> &faces);
+
+    // edgeOf is scratch space, reused from one level to the next
+    static void refine(const HalfEdgeMesh &coarse, HalfEdgeMesh &fine, std::vector<uint32_t> &edgeOf);
+};
+
+#endif // SUBDIVISION_H
@@ -0,0 +1,142 @@
+#include "triangulation.h"
+#include "parallel.h"
+#include <cmath>
+
+void Triangulation::triangulate(HalfEdgeMesh &mesh) {
+    const uint32_t numHalfEdges = mesh.numHalfEdges();
+    const uint32_t numFaces = mesh.numFaces();
+
+    // Face f needs degree - 3 new edges and Faces, placed at the prefix sum of the counts before it
+    std::vector<uint32_t> firstCut(numFaces + 1);
+    parallelFor(0, numFaces, [&](uint32_t f) {
+        firstCut[f + 1] = std::max(mesh.faceDegree(f), 3) - 3;
+    }, 1024);
+    for (uint32_t f = 0; f < numFaces; f++) {
+        firstCut[f + 1] += firstCut[f];
+    }
+    const uint32_t numCuts = firstCut[numFaces];
+    if (numCuts == 0) return;
+
+    mesh.heNext.resize(numHalfEdges + 2 * numCuts);
+    mesh.heSym.resize(numHalfEdges + 2 * numCuts);
+    mesh.heFace.resize(numHalfEdges + 2 * numCuts);
+    mesh.heVert.resize(numHalfEdges + 2 * numCuts);
+    mesh.faceEdge.resize(numFaces + numCuts);
+    mesh.faceColor.resize(numFaces + numCuts);
+
+    parallelFor(0, numFaces, [&](uint32_t f) {
+        const uint32_t cuts = firstCut[f + 1] - firstCut[f];
+        if (cuts == 0) return;
+        const int n = cuts + 3;
+
+        // Corner c is the Vertex HalfEdge c of the Face points to, so inEdge[c] runs from corner c - 1 to c
+        thread_local std::vector<uint32_t> inEdge;
+        thread_local std::vector<glm::vec3> corners;
+        thread_local std::vector<glm::ivec3> triangles;
+        inEdge.resize(n);
+        corners.resize(n);
+        uint32_t edge = mesh.faceEdge[f];
+        for (int c = 0; c < n; c++) {
+            inEdge[c] = edge;
+            corners[c] = mesh.position(mesh.heVert[edge]);
+            edge = mesh.heNext[edge];
+        }
+        earClip(corners.data(), n, triangles);
+
+        // Every ear (i, j, k) but the last closes j's two edges with the new HalfEdge k -> i, and
+        // leaves its sym i -> k as the incoming edge of k in the rest of the polygon
+        for (int t = 0; t < n - 2; t++) {
+            int i = triangles[t].x, j = triangles[t].y, k = triangles[t].z;
+            uint32_t face = f;
+            uint32_t closing = inEdge[i];
+            if (t < n - 3) {
+                uint32_t cut = firstCut[f] + t;
+                face = numFaces + cut;
+                closing = numHalfEdges + 2 * cut;
+                uint32_t sym = closing + 1;
+
+                mesh.heVert[closing] = mesh.heVert[inEdge[i]];
+                mesh.heVert[sym] = mesh.heVert[inEdge[k]];
+                mesh.heSym[closing] = sym;
+                mesh.heSym[sym] = closing;
+                mesh.faceColor[face] = mesh.faceColor[f];
+            }
+
+            mesh.heNext[inEdge[j]] = inEdge[k];
+            mesh.heNext[inEdge[k]] = closing;
+            mesh.heNext[closing] = inEdge[j];
+            mesh.heFace[inEdge[j]] = face;
+            mesh.heFace[inEdge[k]] = face;
+            mesh.heFace[closing] = face;
+            mesh.faceEdge[face] = closing;
+
+            if (t < n - 3) inEdge[k] = closing + 1;
+        }
+    }, 256);
+}
+
+void Triangulation::earClip(const glm::vec3 *corners, int n, std::vector<glm::ivec3> &triangles) {
+    triangles.clear();
+    if (n < 3) return;
+
+    // Project onto the axis plane most facing the Newell normal, keeping the winding counterclockwise
+    glm::vec3 normal(0.f);
+    for (int c = 0; c < n; c++) {
+        const glm::vec3 &a = corners[c];
+        const glm::vec3 &b = corners[(c + 1) % n];
+        normal += glm::vec3((a.y - b.y) * (a.z + b.z), (a.z - b.z) * (a.x + b.x), (a.x - b.x) * (a.y + b.y));
+    }
+    glm::vec3 absNormal = glm::abs(normal);
+    int axis = absNormal.x >= absNormal.y && absNormal.x >= absNormal.z ? 0 : (absNormal.y >= absNormal.z ? 1 : 2);
+    int u = (axis + 1) % 3;
+    int v = (axis + 2) % 3;
+    float winding = normal[axis] < 0.f ? -1.f : 1.f;
+
+    thread_local std::vector<glm::vec2> points;
+    thread_local std::vector<int> prev;
+    thread_local std::vector<int> next;
+    points.resize(n);
+    prev.resize(n);
+    next.resize(n);
+    for (int c = 0; c < n; c++) {
+        points[c] = glm::vec2(corners[c][u], corners[c][v] * winding);
+        prev[c] = (c + n - 1) % n;
+        next[c] = (c + 1) % n;
+    }
+
+    auto cross = [](const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c) {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    };
+    auto isEar = [&](int i, int j, int k) {
+        const glm::vec2 &a = points[i], &b = points[j], &c = points[k];
+        if (cross(a, b, c) <= 0.f) return false;
+        // No other corner may lie inside or on the triangle, except copies of its own corners
+        for (int m = next[k]; m != i; m = next[m]) {
+            const glm::vec2 &p = points[m];
+            if (p == a || p == b || p == c) continue;
+            if (cross(a, b, p) >= 0.f && cross(b, c, p) >= 0.f && cross(c, a, p) >= 0.f) return false;
+        }
+        return true;
+    };
+
+    // Starting at corner 1 makes a convex polygon a fan around corner 0
+    int remaining = n;
+    int j = 1 % n;
+    int misses = 0;
+    while (remaining > 3) {
+        int i = prev[j], k = next[j];
+        // A polygon left without any ear is degenerate or self-intersecting, clip the corner anyway
+        if (isEar(i, j, k) || misses >= remaining) {
+            triangles.emplace_back(i, j, k);
+            next[i] = k;
+            prev[k] = i;
+            remaining--;
+            misses = 0;
+            j = k;
+        } else {
+            misses++;
+            j = next[j];
+        }
+    }
+    triangles.emplace_back(prev[j], j, next[j]);
+}
@@ -0,0 +1,24 @@
+#ifndef TRIANGULATION_H
+#define TRIANGULATION_H
+
+#include "halfedgemesh.h"
+
+// Whole-mesh triangulation by ear clipping, for n-gons that may be non-convex.
+// A Face of degree n becomes n - 2 triangles joined by n - 3 new edges. Each Face's share of the
+// new elements is known from its degree alone, so the arrays are grown once to their exact final
+// size from a prefix sum of the degrees and every Face is then clipped in parallel into its own slots.
+class Triangulation
+{
+public:
+    // Triangulate every Face of mesh. The output is the same whatever the number of threads:
+    // Face f keeps its index for its last triangle, and its other triangles and new HalfEdges follow
+    // the existing ones in the order of f. New triangles take the color of the Face they come from.
+    static void triangulate(HalfEdgeMesh &mesh);
+
+    // Ear-clip the polygon of n corners into n - 2 triangles, written to triangles as corner indices.
+    // corners holds the polygon's positions in order. Ears are clipped in order of appearance so that
+    // a convex polygon gives a fan, and a degenerate polygon that has no ear is fanned from there on.
+    static void earClip(const glm::vec3 *corners, int n, std::vector<glm::ivec3> &triangles);
+};
+
+#endif // TRIANGULATION_H
@@ -1,13 +1,13 @@
 #include "vertexdisplay.h"
 
 VertexDisplay::VertexDisplay(OpenGLContext* context)
-   : Drawable(context), representedVertex(nullptr)
+   : Drawable(context), mesh(nullptr), representedVertex(NO_INDEX)
 {}
 
 void VertexDisplay::create() {
-    if (representedVertex) {
+    if (mesh && representedVertex != NO_INDEX) {
 
-        glm::vec4 pos = glm::vec4(representedVertex->pos, 1.f);
+        glm::vec4 pos = glm::vec4(mesh->position(representedVertex), 1.f);
         glm::vec4 color = glm::vec4(1.f);
         GLuint idx = 0;
 
@@ -31,6 +31,7 @@ GLenum VertexDisplay::drawMode() {
     return GL_POINTS;
 }
 
-void VertexDisplay::updateVertex(Vertex* vert) {
+void VertexDisplay::updateVertex(const HalfEdgeMesh* mesh, uint32_t vert) {
+    this->mesh = mesh;
     representedVertex = vert;
 }
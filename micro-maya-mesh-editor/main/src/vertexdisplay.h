@@ -1,12 +1,13 @@
 #ifndef VERTEXDISPLAY_H
 #define VERTEXDISPLAY_H
 
-#include "vertex.h"
+#include "halfedgemesh.h"
 #include <drawable.h>
 
 class VertexDisplay : public Drawable {
 protected:
-    Vertex *representedVertex;
+    const HalfEdgeMesh *mesh;
+    uint32_t representedVertex;
 
 public:
     VertexDisplay(OpenGLContext* context);
@@ -17,8 +18,8 @@ public:
     // A selected Vertex should be represented as a white GL_POINTS
     GLenum drawMode() override;
 
-    // Change which Vertex representedVertex points to
-    void updateVertex(Vertex*);
+    // Change which Vertex of the mesh is represented, NO_INDEX for none
+    void updateVertex(const HalfEdgeMesh*, uint32_t);
 };
 
 #endif // VERTEXDISPLAY_H
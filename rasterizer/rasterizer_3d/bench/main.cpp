@@ -0,0 +1,110 @@
+#include "rasterizer.h"
+#include "objloader.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+#ifdef TILEDBUFFER_TRACE
+// A set-associative cache with LRU replacement, counting the misses of the lines it is given
+class CacheModel
+{
+public:
+    CacheModel(int size, int ways, int line)
+        : m_ways(ways), m_lineShift(0), m_sets(size / (ways * line)),
+          m_tags(m_sets * ways, UINTPTR_MAX), m_ages(m_sets * ways, 0), m_clock(0),
+          accesses(0), misses(0)
+    {
+        while ((1 << m_lineShift) < line) m_lineShift++;
+    }
+
+    // Returns true on a hit
+    bool Access(uintptr_t address)
+    {
+        uintptr_t tag = address >> m_lineShift;
+        int base = (tag % m_sets) * m_ways;
+        int victim = base;
+        accesses++;
+        m_clock++;
+        for (int i = base; i < base + m_ways; i++) {
+            if (m_tags[i] == tag) {
+                m_ages[i] = m_clock;
+                return true;
+            }
+            if (m_ages[i] < m_ages[victim]) victim = i;
+        }
+        misses++;
+        m_tags[victim] = tag;
+        m_ages[victim] = m_clock;
+        return false;
+    }
+
+private:
+    int m_ways;
+    int m_lineShift;
+    int m_sets;
+    std::vector<uintptr_t> m_tags;
+    std::vector<uint64_t> m_ages;
+    uint64_t m_clock;
+
+public:
+    uint64_t accesses;
+    uint64_t misses;
+};
+
+// A typical desktop core: 32 KiB 8-way L1 and 1 MiB 16-way L2 with 64 byte lines
+static CacheModel l1(32 * 1024, 8, 64);
+static CacheModel l2(1024 * 1024, 16, 64);
+
+void TiledBufferTrace(const void *texel)
+{
+    uintptr_t address = reinterpret_cast<uintptr_t>(texel);
+    if (!l1.Access(address)) l2.Access(address);
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3 || (std::strcmp(argv[2], "linear") != 0 && std::strcmp(argv[2], "tiled") != 0)) {
+        std::fprintf(stderr, "usage: %s SCENE.obj linear|tiled [FRAMES] [ANTIALIASING] [shadows]\n", argv[0]);
+        return 1;
+    }
+    int frames = argc > 3 ? std::atoi(argv[3]) : 10;
+    int antialiasing = argc > 4 ? std::atoi(argv[4]) : 2;
+    bool shadows = argc > 5 && std::strcmp(argv[5], "shadows") == 0;
+
+    Polygon p("bench");
+    std::string errors = LoadOBJ(argv[1], p);
+    if (errors.size() != 0) {
+        std::fprintf(stderr, "%s\n", errors.c_str());
+        return 1;
+    }
+    std::vector<Polygon> polygons(1, p);
+
+    // A fixed three-quarter view, Lambert shaded
+    Rasterizer rasterizer(polygons);
+    rasterizer.tiled = std::strcmp(argv[2], "tiled") == 0;
+    rasterizer.antialiasing = antialiasing;
+    rasterizer.shader = 1;
+    rasterizer.shadows = shadows;
+    rasterizer.camera.RotateUp(0.4f);
+    rasterizer.camera.RotateRight(0.3f);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        rasterizer.RenderScene();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("%s %dx%d%s: %.2f ms/frame over %d frames\n", argv[2],
+                rasterizer.render_width, rasterizer.render_height, shadows ? " shadows" : "",
+                elapsed.count() / frames, frames);
+#ifdef TILEDBUFFER_TRACE
+    std::printf("framebuffer accesses/frame %llu, L1 misses/frame %llu (%.2f%%), L2 misses/frame %llu\n",
+                (unsigned long long)(l1.accesses / frames), (unsigned long long)(l1.misses / frames),
+                100.0 * l1.misses / l1.accesses, (unsigned long long)(l2.misses / frames));
+#endif
+    return 0;
+}
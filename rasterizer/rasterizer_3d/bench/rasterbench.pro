@@ -0,0 +1,35 @@
+# Renders a fixed scene with linear or tiled render targets and reports the time per frame.
+# Run it under perf stat to compare cache misses, e.g.
+#   perf stat -e L1-dcache-load-misses,LLC-load-misses ./rasterbench ../../scenes/wahoo.obj tiled
+# With CONFIG += trace every framebuffer access also goes through a cache model that is
+# printed after the frames, for machines where hardware counters are not available.
+QT = core gui
+
+TARGET = rasterbench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += .. ../include
+
+trace {
+    DEFINES += TILEDBUFFER_TRACE
+}
+
+SOURCES += \
+    main.cpp \
+    ../objloader.cpp \
+    ../polygon.cpp \
+    ../rasterizer.cpp \
+    ../shaders.cpp \
+    ../shadowmap.cpp \
+    ../tiny_obj_loader.cc
+
+HEADERS += \
+    ../objloader.h \
+    ../polygon.h \
+    ../rasterizer.h \
+    ../shaders.h \
+    ../shadowmap.h \
+    ../tiledbuffer.h \
+    ../tiny_obj_loader.h
@@ -11,7 +11,7 @@
 #include <QKeyEvent>
 #include <QImageWriter>
 #include <QDebug>
-#include <tiny_obj_loader.h>
+#include <objloader.h>
 
 //Poke around in this file if you want, but it's virtually uncommented!
 //You won't need to modify anything in here to complete the assignment.
@@ -53,6 +53,9 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->AA, SIGNAL(valueChanged(int)), this, SLOT(slot_setAA(int)));
     connect(ui->LAMBER, SIGNAL(toggled(bool)), this, SLOT(on_checkBoxLambertian_toggled(bool)));
     connect(ui->TOON, SIGNAL(toggled(bool)), this, SLOT(on_checkBoxToon_toggled(bool)));
+    connect(ui->TILED, SIGNAL(toggled(bool)), this, SLOT(on_checkBoxTiled_toggled(bool)));
+    connect(ui->SHADOWS, SIGNAL(toggled(bool)), this, SLOT(on_checkBoxShadows_toggled(bool)));
+    connect(ui->PREPASS, SIGNAL(toggled(bool)), this, SLOT(on_checkBoxPrepass_toggled(bool)));
 }
 
 MainWindow::~MainWindow()
@@ -160,52 +163,8 @@ void MainWindow::on_actionLoad_Scene_triggered()
 Polygon MainWindow::LoadOBJ(const QString &file, const QString &polyName)
 {
     Polygon p(polyName);
-    QString filepath = file;
-    std::vector<tinyobj::shape_t> shapes; std::vector<tinyobj::material_t> materials;
-    std::string errors = tinyobj::LoadObj(shapes, materials, filepath.toStdString().c_str());
-    std::cout << errors << std::endl;
-    if(errors.size() == 0)
-    {
-        int min_idx = 0;
-        //Read the information from the vector of shape_ts
-        for(unsigned int i = 0; i < shapes.size(); i++)
-        {
-            std::vector<glm::vec4> pos, nor;
-            std::vector<glm::vec2> uv;
-            std::vector<float> &positions = shapes[i].mesh.positions;
-            std::vector<float> &normals = shapes[i].mesh.normals;
-            std::vector<float> &uvs = shapes[i].mesh.texcoords;
-            for(unsigned int j = 0; j < positions.size()/3; j++)
-            {
-                pos.push_back(glm::vec4(positions[j*3], positions[j*3+1], positions[j*3+2],1));
-            }
-            for(unsigned int j = 0; j < normals.size()/3; j++)
-            {
-                nor.push_back(glm::vec4(normals[j*3], normals[j*3+1], normals[j*3+2],0));
-            }
-            for(unsigned int j = 0; j < uvs.size()/2; j++)
-            {
-                uv.push_back(glm::vec2(uvs[j*2], uvs[j*2+1]));
-            }
-            for(unsigned int j = 0; j < pos.size(); j++)
-            {
-                p.AddVertex(Vertex(pos[j], glm::vec3(255,255,255), nor[j], uv[j]));
-            }
-
-            std::vector<unsigned int> indices = shapes[i].mesh.indices;
-            for(unsigned int j = 0; j < indices.size(); j += 3)
-            {
-                Triangle t;
-                t.m_indices[0] = indices[j] + min_idx;
-                t.m_indices[1] = indices[j+1] + min_idx;
-                t.m_indices[2] = indices[j+2] + min_idx;
-                p.AddTriangle(t);
-            }
-
-            min_idx += pos.size();
-        }
-    }
-    else
+    std::string errors = ::LoadOBJ(file.toStdString(), p);
+    if(errors.size() != 0)
     {
         //An error loading the OBJ occurred!
         std::cout << errors << std::endl;
@@ -290,3 +249,24 @@ void MainWindow::on_checkBoxToon_toggled(bool checked)
     rendered_image = rasterizer.RenderScene();
     DisplayQImage(rendered_image);
 }
+
+void MainWindow::on_checkBoxTiled_toggled(bool checked)
+{
+    rasterizer.tiled = checked;
+    rendered_image = rasterizer.RenderScene();
+    DisplayQImage(rendered_image);
+}
+
+void MainWindow::on_checkBoxShadows_toggled(bool checked)
+{
+    rasterizer.shadows = checked;
+    rendered_image = rasterizer.RenderScene();
+    DisplayQImage(rendered_image);
+}
+
+void MainWindow::on_checkBoxPrepass_toggled(bool checked)
+{
+    rasterizer.depth_prepass = checked;
+    rendered_image = rasterizer.RenderScene();
+    DisplayQImage(rendered_image);
+}
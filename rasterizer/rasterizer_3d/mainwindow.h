@@ -27,6 +27,9 @@ public slots:
     void slot_setAA(int);
     void on_checkBoxLambertian_toggled(bool checked);
     void on_checkBoxToon_toggled(bool checked);
+    void on_checkBoxTiled_toggled(bool checked);
+    void on_checkBoxShadows_toggled(bool checked);
+    void on_checkBoxPrepass_toggled(bool checked);
 
 private slots:
     void on_actionLoad_Scene_triggered();
@@ -0,0 +1,39 @@
+#include "objloader.h"
+#include <tiny_obj_loader.h>
+
+std::string LoadOBJ(const std::string &file, Polygon &poly)
+{
+    std::vector<tinyobj::shape_t> shapes; std::vector<tinyobj::material_t> materials;
+    std::string errors = tinyobj::LoadObj(shapes, materials, file.c_str());
+    if (errors.size() != 0) return errors;
+
+    int min_idx = poly.m_verts.size();
+    //Read the information from the vector of shape_ts
+    for (const tinyobj::shape_t &shape : shapes)
+    {
+        const std::vector<float> &positions = shape.mesh.positions;
+        const std::vector<float> &normals = shape.mesh.normals;
+        const std::vector<float> &uvs = shape.mesh.texcoords;
+        int count = positions.size() / 3;
+        for (int j = 0; j < count; j++)
+        {
+            glm::vec4 pos(positions[j*3], positions[j*3+1], positions[j*3+2], 1);
+            glm::vec4 nor = normals.size() ? glm::vec4(normals[j*3], normals[j*3+1], normals[j*3+2], 0) : glm::vec4(0, 0, 1, 0);
+            glm::vec2 uv = uvs.size() ? glm::vec2(uvs[j*2], uvs[j*2+1]) : glm::vec2(0);
+            poly.AddVertex(Vertex(pos, glm::vec3(255, 255, 255), nor, uv));
+        }
+
+        const std::vector<unsigned int> &indices = shape.mesh.indices;
+        for (unsigned int j = 0; j + 2 < indices.size(); j += 3)
+        {
+            Triangle t;
+            t.m_indices[0] = indices[j] + min_idx;
+            t.m_indices[1] = indices[j+1] + min_idx;
+            t.m_indices[2] = indices[j+2] + min_idx;
+            poly.AddTriangle(t);
+        }
+
+        min_idx += count;
+    }
+    return errors;
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <polygon.h>
+#include <string>
+
+// Appends every shape of a Wavefront .obj file to poly as white vertices, with the file's
+// normals and uvs when it has them. Returns the loader's error message, empty on success.
+// Shared by MainWindow and rasterbench, so it uses no Qt beyond Polygon itself.
+std::string LoadOBJ(const std::string &file, Polygon &poly);
@@ -93,9 +93,9 @@ std::array<Segment, 3> Polygon::GetTriangleEdges(const Triangle &tri)
 
 glm::vec3 Polygon::GetBarycentricWeight(const Triangle &tri, float x, float y)
 {
-    Vertex v1 = m_pixel_verts[tri.m_indices[0]];
-    Vertex v2 = m_pixel_verts[tri.m_indices[1]];
-    Vertex v3 = m_pixel_verts[tri.m_indices[2]];
+    const Vertex &v1 = m_pixel_verts[tri.m_indices[0]];
+    const Vertex &v2 = m_pixel_verts[tri.m_indices[1]];
+    const Vertex &v3 = m_pixel_verts[tri.m_indices[2]];
 
     glm::vec4 pos  = glm::vec4(x, y, 0.f, 0.f);
 
@@ -107,46 +107,14 @@ glm::vec3 Polygon::GetBarycentricWeight(const Triangle &tri, float x, float y)
     return glm::vec3(S1 / (v1.m_pos.z + 1e-9), S2 / (v2.m_pos.z + 1e-9), S3 / (v3.m_pos.z + 1e-9)) / S;
 }
 
-glm::vec3 Polygon::GetBarycentricColor(const Triangle &tri, float x, float y)
+float Polygon::GetDepth(const Triangle &tri, const glm::vec3 &weight)
 {
-    Vertex v1 = m_verts[tri.m_indices[0]];
-    Vertex v2 = m_verts[tri.m_indices[1]];
-    Vertex v3 = m_verts[tri.m_indices[2]];
-
-    glm::vec3 weight = GetBarycentricWeight(tri, x, y);
-    float z = 1 / (weight.x + weight.y + weight.z);
-
-    return z * (v1.m_color * weight.x + v2.m_color * weight.y + v3.m_color * weight.z);
-}
-
-float Polygon::GetBarycentricZ(const Triangle &tri, float x, float y)
-{
-    glm::vec3 weight = GetBarycentricWeight(tri, x, y);
-    return 1 / (weight.x + weight.y + weight.z);
-}
-
-glm::vec2 Polygon::GetBarycentricUV(const Triangle &tri, float x, float y)
-{
-    Vertex v1 = this->m_verts[tri.m_indices[0]];
-    Vertex v2 = this->m_verts[tri.m_indices[1]];
-    Vertex v3 = this->m_verts[tri.m_indices[2]];
-
-    glm::vec3 weight = GetBarycentricWeight(tri, x, y);
-    float z = 1 / (weight.x + weight.y + weight.z);
-
-    return z * (v1.m_uv * weight.x + v2.m_uv * weight.y + v3.m_uv * weight.z);
-}
-
-glm::vec4 Polygon::GetBarycentricNormal(const Triangle &tri, float x, float y)
-{
-    Vertex v1 = this->m_verts[tri.m_indices[0]];
-    Vertex v2 = this->m_verts[tri.m_indices[1]];
-    Vertex v3 = this->m_verts[tri.m_indices[2]];
-
-    glm::vec3 weight = GetBarycentricWeight(tri, x, y);
-    float z = 1 / (weight.x + weight.y + weight.z);
+    float z1 = m_pixel_verts[tri.m_indices[0]].m_pos.z;
+    float z2 = m_pixel_verts[tri.m_indices[1]].m_pos.z;
+    float z3 = m_pixel_verts[tri.m_indices[2]].m_pos.z;
 
-    return z * (v1.m_normal * weight.x + v2.m_normal * weight.y + v3.m_normal * weight.z);
+    // Undo the division by z of GetBarycentricWeight to get the screen-space weights
+    return weight.x * (z1 + 1e-9) * z1 + weight.y * (z2 + 1e-9) * z2 + weight.z * (z3 + 1e-9) * z3;
 }
 
 // Creates a polygon from the input list of vertex positions and colors
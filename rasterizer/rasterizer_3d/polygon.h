@@ -92,10 +92,10 @@ public:
     std::array<float, 4> GetBoudingBox(const Triangle &tri);
     std::array<Segment, 3> GetTriangleEdges(const Triangle &tri);
     glm::vec3 GetBarycentricWeight(const  Triangle &tri, float x, float y);
-    glm::vec3 GetBarycentricColor(const Triangle &tri, float x, float y);
-    float GetBarycentricZ(const Triangle &tri, float x, float y);
-    glm::vec2 GetBarycentricUV(const Triangle &tri, float x, float y);
-    glm::vec4 GetBarycentricNormal(const Triangle &tri, float x, float y);
+    // The pixel-space z of a triangle at a point, given its GetBarycentricWeight().
+    // z/w is affine in screen space, so unlike 1/(weight.x + weight.y + weight.z)
+    // this is the depth the projection of any point on the triangle has.
+    float GetDepth(const Triangle &tri, const glm::vec3 &weight);
 };
 
 // Returns the color of the pixel in the image at the specified texture coordinates.
@@ -7,51 +7,181 @@
 
 Rasterizer::Rasterizer(const std::vector<Polygon>& polygons)
     : m_polygons(polygons)
-{}
+{
+    // A key light above and to the right of the default camera
+    light.LookAt(glm::vec3(6.f, 8.f, 10.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+    light.near = 1.f;
+    light.far = 50.f;
+}
 
 QImage Rasterizer::RenderScene()
 {
     render_width = window_width * antialiasing;
     render_height = window_width * antialiasing;
 
-    QImage result(render_width, render_height, QImage::Format_RGB32);
-    result.fill(qRgb(0.f, 0.f, 0.f));
-    std::vector<float> z_buffer = std::vector<float>(render_width * render_height, std::numeric_limits<float>::infinity());
+    TiledBuffer<QRgb> color_buffer(render_width, render_height, tiled, qRgb(0.f, 0.f, 0.f));
+    TiledBuffer<float> z_buffer(render_width, render_height, tiled, std::numeric_limits<float>::infinity());
+
+    // Light-space depth pass
+    ShadowMap shadow_map(shadows ? shadow_resolution : 0, light.GetProjectionMatrix() * light.GetViewMatrix(), tiled);
+    if (shadows) {
+        RenderDepth(shadow_map.depth, light);
+    }
+    glm::vec4 lightDir = shadows ? -light.forward : -camera.forward;
+
+    // Depth pre-pass, after which only the visible surface of each pixel is shaded
+    if (depth_prepass) {
+        RenderDepth(z_buffer, camera);
+    }
 
     // Scan each polygon
     for (Polygon &poly : m_polygons) {
-        // Transform vetices
-        TransformToPixelSpace(poly);
-
-        // Scan each triangle
-        for (Triangle &tri : poly.m_tris) {
-            std::array<float, 4> bbox = poly.GetBoudingBox(tri);
-
-            float lx = bbox[0];
-            float ly = bbox[1];
-            float hx = bbox[2];
-            float hy = bbox[3];
-
-            // Whole triangle outside of screen, skip
-            if (lx >= render_width || ly >= render_height || hx < 0 || hy < 0) continue;
-
-            // Scan each row
-            int row_start = std::max((int) floor(ly), 0);
-            int row_end = std::min((int) ceil(hy), render_height);
-            for (int row = row_start; row < row_end; row ++) {
-                RenderRow(result, (float) row, poly, tri, bbox, z_buffer);
+        // Transform vetices, unless the pre-pass already did
+        if (!depth_prepass) {
+            TransformToPixelSpace(poly, camera, render_width, render_height);
+        }
+
+        if (shader == 1) {
+            LambertShader lambert(lightDir, 1.f, .3f);
+            if (shadows) {
+                RenderPolygon(color_buffer, poly, ShadowedShader<LambertShader>(lambert, shadow_map), z_buffer);
+            } else {
+                RenderPolygon(color_buffer, poly, lambert, z_buffer);
             }
+        } else if (shader == 2) {
+            ToonShader toon(lightDir, 1.f, .3f, 3);
+            if (shadows) {
+                RenderPolygon(color_buffer, poly, ShadowedShader<ToonShader>(toon, shadow_map), z_buffer);
+            } else {
+                RenderPolygon(color_buffer, poly, toon, z_buffer);
+            }
+        } else {
+            RenderPolygon(color_buffer, poly, UnlitShader(), z_buffer);
         }
     }
 
+    // Linearize to row-major only once the whole scene is rasterized
+    QImage result(render_width, render_height, QImage::Format_RGB32);
+    color_buffer.Resolve(result);
+
     return result.scaled(window_width, window_height, Qt::KeepAspectRatio, Qt::SmoothTransformation);;
 }
 
-void Rasterizer::RenderRow(QImage &result, float row, Polygon &poly, Triangle &tri, std::array<float, 4> &bbox, std::vector<float> &z_buffer)
+void Rasterizer::RenderDepth(TiledBuffer<float> &z_buffer, const Camera &view)
+{
+    for (Polygon &poly : m_polygons) {
+        TransformToPixelSpace(poly, view, z_buffer.Width(), z_buffer.Height());
+        RenderPolygonDepth(poly, z_buffer);
+    }
+}
+
+void Rasterizer::RenderPolygonDepth(Polygon &poly, TiledBuffer<float> &z_buffer)
+{
+    int width = z_buffer.Width();
+    int height = z_buffer.Height();
+
+    for (Triangle &tri : poly.m_tris) {
+        std::array<float, 4> bbox = poly.GetBoudingBox(tri);
+
+        // Whole triangle outside of the buffer, skip
+        if (bbox[0] >= width || bbox[1] >= height || bbox[2] < 0 || bbox[3] < 0) continue;
+
+        std::array<Segment, 3> edges = poly.GetTriangleEdges(tri);
+
+        int row_start = std::max((int) floor(bbox[1]), 0);
+        int row_end = std::min((int) ceil(bbox[3]), height);
+        for (int row = row_start; row < row_end; row ++) {
+            int col_start, col_end;
+            GetRowSpan((float) row, bbox, edges, width, col_start, col_end);
+            int row_base = z_buffer.RowBase(row);
+
+            // Depth writes only: no texture fetch and no varyings
+            for (int col = col_start; col < col_end; col ++) {
+                glm::vec3 weight = poly.GetBarycentricWeight(tri, (float) col, (float) row);
+                float z = poly.GetDepth(tri, weight);
+                int idx = z_buffer.Offset(row_base, col);
+                if (z < z_buffer[idx]) {
+                    z_buffer[idx] = z;
+                }
+            }
+        }
+    }
+}
+
+template<typename Shader>
+void Rasterizer::RenderPolygon(TiledBuffer<QRgb> &color_buffer, Polygon &poly, const Shader &program, TiledBuffer<float> &z_buffer)
+{
+    typedef typename Shader::Varyings Varyings;
+
+    // Scan each triangle
+    for (Triangle &tri : poly.m_tris) {
+        std::array<float, 4> bbox = poly.GetBoudingBox(tri);
+
+        float lx = bbox[0];
+        float ly = bbox[1];
+        float hx = bbox[2];
+        float hy = bbox[3];
+
+        // Whole triangle outside of screen, skip
+        if (lx >= render_width || ly >= render_height || hx < 0 || hy < 0) continue;
+
+        // Only the attributes the shader declares are fetched and interpolated
+        Varyings corners[3] = {Varyings::FromVertex(poly.m_verts[tri.m_indices[0]]),
+                               Varyings::FromVertex(poly.m_verts[tri.m_indices[1]]),
+                               Varyings::FromVertex(poly.m_verts[tri.m_indices[2]])};
+        std::array<Segment, 3> edges = poly.GetTriangleEdges(tri);
+
+        // Scan each row
+        int row_start = std::max((int) floor(ly), 0);
+        int row_end = std::min((int) ceil(hy), render_height);
+        for (int row = row_start; row < row_end; row ++) {
+            RenderRow(color_buffer, (float) row, poly, tri, bbox, edges, program, corners, z_buffer);
+        }
+    }
+}
+
+template<typename Shader>
+void Rasterizer::RenderRow(TiledBuffer<QRgb> &color_buffer, float row, Polygon &poly, Triangle &tri,
+                           std::array<float, 4> &bbox, std::array<Segment, 3> &edges,
+                           const Shader &program, const typename Shader::Varyings (&corners)[3],
+                           TiledBuffer<float> &z_buffer)
 {
-    std::array<Segment, 3> edges = poly.GetTriangleEdges(tri);
+    int col_start, col_end;
+    GetRowSpan(row, bbox, edges, render_width, col_start, col_end);
+    int row_base = z_buffer.RowBase((int) row);
+
+    for (int col = col_start; col < col_end; col ++) {
+        // The weights are computed once and shared by the depth test and every varying
+        glm::vec3 weight = poly.GetBarycentricWeight(tri, (float) col, (float) row);
+        float depth = poly.GetDepth(tri, weight);
+        int idx = z_buffer.Offset(row_base, col);
+
+        if (depth_prepass) {
+            // The buffer already holds the nearest depth, shade only that surface. Of fragments
+            // tied at that depth the pre-pass kept the first one drawn, so shade the first one
+            // and mark the pixel done, which the depth of every later fragment exceeds.
+            if (depth > z_buffer[idx]) continue;
+            z_buffer[idx] = -std::numeric_limits<float>::infinity();
+        } else {
+            // Render only if it's smaller in z
+            if (depth >= z_buffer[idx]) continue;
+            z_buffer[idx] = depth;
+        }
+
+        // Perspective correction of the varyings
+        float z = 1 / (weight.x + weight.y + weight.z);
+
+        glm::vec3 color = program.Shade(poly, InterpolateVaryings(corners, weight, z));
+        color = glm::clamp(color, 0.f, 255.f);
+
+        color_buffer[idx] = qRgb(color.r, color.g, color.b);
+    }
+}
 
-    float left = (float) render_width - 1.f;
+void Rasterizer::GetRowSpan(float row, const std::array<float, 4> &bbox, std::array<Segment, 3> &edges,
+                            int width, int &col_start, int &col_end)
+{
+    float left = (float) width - 1.f;
     float right = 0.f;
 
     for (int i = 0; i < 3; i++) {
@@ -64,44 +194,17 @@ void Rasterizer::RenderRow(QImage &result, float row, Polygon &poly, Triangle &t
         }
     }
 
-    int col_start = std::max((int) ceil(left), 0);
-    int col_end = std::min((int) ceil(right), render_width);
-
-    for (int col = col_start; col < col_end; col ++) {
-        // Render only if it's smaller in z
-        float z = poly.GetBarycentricZ(tri, (float) col, (float) row);
-        int idx = col + render_height * row;
-        if (z < z_buffer[idx]) {
-            z_buffer[idx] = z;
-
-            glm::vec2 UV = poly.GetBarycentricUV(tri, (float) col, (float) row);
-            glm::vec3 color = GetImageColor(UV, poly.mp_texture);
-            if (shader == 1) {
-                color = GetLambertianColor(color,
-                                           poly.GetBarycentricNormal(tri, col, row),
-                                           -camera.forward,
-                                           1.f,
-                                           .3f);
-            }
-            else if (shader == 2) {
-                color = GetToonColor(color,
-                                     poly.GetBarycentricNormal(tri, col, row),
-                                     -camera.forward,
-                                     1.f,
-                                     .3f,
-                                     3);
-            }
-            color = glm::clamp(color, 0.f, 255.f);
-
-            result.setPixel(col, row, qRgb(color.r, color.g, color.b));
-        }
-    }
+    col_start = std::max((int) ceil(left), 0);
+    col_end = std::min((int) ceil(right), width);
 }
 
-void Rasterizer::TransformToPixelSpace(Polygon &poly)
+void Rasterizer::TransformToPixelSpace(Polygon &poly, const Camera &view, int width, int height)
 {
-    poly.m_pixel_verts = std::vector<Vertex>(poly.m_verts);
-    glm::mat4 T = camera.GetProjectionMatrix() * camera.GetViewMatrix();
+    // Only positions change between passes, the other attributes are copied once
+    if (poly.m_pixel_verts.size() != poly.m_verts.size()) {
+        poly.m_pixel_verts = std::vector<Vertex>(poly.m_verts);
+    }
+    glm::mat4 T = view.GetProjectionMatrix() * view.GetViewMatrix();
     for (size_t i = 0; i < poly.m_verts.size(); i ++)
     {
         glm::vec4 transformedPos = T * poly.m_verts[i].m_pos;
@@ -110,27 +213,12 @@ void Rasterizer::TransformToPixelSpace(Polygon &poly)
         transformedPos = transformedPos / transformedPos.w;
 
         // NDC -> Pixel
-        transformedPos.x = (transformedPos.x + 1) * render_width / 2;
-        transformedPos.y = (1 - transformedPos.y) * render_height / 2;
+        transformedPos.x = (transformedPos.x + 1) * width / 2;
+        transformedPos.y = (1 - transformedPos.y) * height / 2;
         poly.m_pixel_verts[i].m_pos = transformedPos;
     }
 }
 
-glm::vec3 Rasterizer::GetLambertianColor(glm::vec3 color, glm::vec4 normal, glm::vec4 lightDir, float albedo, float ambient)
-{
-    lightDir = glm::normalize(lightDir);
-    float attenuate = glm::clamp(glm::dot(normal, lightDir), 0.f, 1.f);
-    return albedo * (attenuate + ambient) * color;
-}
-
-glm::vec3 Rasterizer::GetToonColor(glm::vec3 color, glm::vec4 normal, glm::vec4 lightDir, float albedo, float ambient, int numTones)
-{
-    lightDir = glm::normalize(lightDir);
-    float attenuate = glm::clamp(glm::dot(normal, lightDir), 0.f, 1.f);
-    float quantized = std::round(attenuate * numTones) / numTones;
-    return color * (albedo * (quantized + ambient));
-}
-
 Camera::Camera() :
     forward(glm::vec4(0.f, 0.f, -1.f, 0.f)),
     right(glm::vec4(1.f, 0.f, 0.f, 0.f)),
@@ -141,7 +229,7 @@ Camera::Camera() :
     far(100.f),
     ratio(1.f) {}
 
-glm::mat4 Camera::GetViewMatrix()
+glm::mat4 Camera::GetViewMatrix() const
 {
     glm::mat4 O = glm::mat4(
         glm::vec4(right.x, up.x, forward.x, 0.f),
@@ -160,7 +248,7 @@ glm::mat4 Camera::GetViewMatrix()
     return O * T;
 }
 
-glm::mat4 Camera::GetProjectionMatrix()
+glm::mat4 Camera::GetProjectionMatrix() const
 {
     float S = 1 / glm::tan(FOV/2);
     float A = ratio;
@@ -175,6 +263,18 @@ glm::mat4 Camera::GetProjectionMatrix()
         );
 }
 
+void Camera::LookAt(const glm::vec3 &eye, const glm::vec3 &target, const glm::vec3 &worldUp)
+{
+    glm::vec3 f = glm::normalize(target - eye);
+    glm::vec3 r = glm::normalize(glm::cross(f, worldUp));
+    glm::vec3 u = glm::cross(r, f);
+
+    forward = glm::vec4(f, 0.f);
+    right = glm::vec4(r, 0.f);
+    up = glm::vec4(u, 0.f);
+    pos = glm::vec4(eye, 1.f);
+}
+
 void Camera::TranslateForward(const float c)
 {
     pos += forward * c;
@@ -1,5 +1,8 @@
 #pragma once
 #include <polygon.h>
+#include <tiledbuffer.h>
+#include <shaders.h>
+#include <shadowmap.h>
 #include <QImage>
 
 class Camera
@@ -17,8 +20,10 @@ public:
 
     Camera();
 
-    glm::mat4 GetViewMatrix();
-    glm::mat4 GetProjectionMatrix();
+    glm::mat4 GetViewMatrix() const;
+    glm::mat4 GetProjectionMatrix() const;
+
+    void LookAt(const glm::vec3 &eye, const glm::vec3 &target, const glm::vec3 &worldUp);
 
     void TranslateForward(const float c);
     void TranslateRight(const float c);
@@ -42,19 +47,42 @@ public:
     int render_width = 512;
     int render_height = 512;
 
+    // Store the depth and color buffers in Morton-ordered 8x8 tiles instead of rows
+    bool tiled = false;
+
     // 0 Nothing 1 Lambertian 2 Toon
     int shader = 0;
 
+    // Render a depth map from the light and let Lambert/toon sample it
+    bool shadows = false;
+    int shadow_resolution = 1024;
+
+    // Fill the depth buffer with a depth-only pass first, so each pixel is shaded once
+    bool depth_prepass = false;
+
     Camera camera;
+    Camera light;
     Rasterizer(const std::vector<Polygon>& polygons);
     QImage RenderScene();
     void ClearScene();
-    void RenderRow(QImage &result, float row, Polygon &poly, Triangle &tri, std::array<float, 4> &bbox, std::vector<float> &z_buffer);
-    void TransformToPixelSpace(Polygon &poly);
+    void TransformToPixelSpace(Polygon &poly, const Camera &view, int width, int height);
+
+    // Depth-only rendering of every polygon as seen from view, sized to z_buffer
+    void RenderDepth(TiledBuffer<float> &z_buffer, const Camera &view);
+    void RenderPolygonDepth(Polygon &poly, TiledBuffer<float> &z_buffer);
 
-    glm::vec3 GetLambertianColor(glm::vec3 color, glm::vec4 normal, glm::vec4 lightDir, float albedo, float ambient);
-    glm::vec3 GetToonColor(glm::vec3 color, glm::vec4 normal, glm::vec4 lightDir, float albedo, float ambient, int numTones);
+    template<typename Shader>
+    void RenderPolygon(TiledBuffer<QRgb> &color_buffer, Polygon &poly, const Shader &program, TiledBuffer<float> &z_buffer);
+    template<typename Shader>
+    void RenderRow(TiledBuffer<QRgb> &color_buffer, float row, Polygon &poly, Triangle &tri,
+                   std::array<float, 4> &bbox, std::array<Segment, 3> &edges,
+                   const Shader &program, const typename Shader::Varyings (&corners)[3],
+                   TiledBuffer<float> &z_buffer);
 
+private:
+    // The columns covered by the triangle with the given edges on a scanline
+    void GetRowSpan(float row, const std::array<float, 4> &bbox, std::array<Segment, 3> &edges,
+                    int width, int &col_start, int &col_end);
 };
 
 
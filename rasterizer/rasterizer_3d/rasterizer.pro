@@ -13,13 +13,20 @@ TEMPLATE = app
 
 SOURCES += main.cpp\
         mainwindow.cpp \
+    objloader.cpp \
     polygon.cpp \
     rasterizer.cpp \
+    shaders.cpp \
+    shadowmap.cpp \
     tiny_obj_loader.cc
 
 HEADERS  += mainwindow.h \
+    objloader.h \
     polygon.h \
     rasterizer.h \
+    shaders.h \
+    shadowmap.h \
+    tiledbuffer.h \
     tiny_obj_loader.h
 
 FORMS    += mainwindow.ui
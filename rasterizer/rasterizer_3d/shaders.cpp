@@ -0,0 +1,29 @@
+#include "shaders.h"
+
+glm::vec3 UnlitShader::Shade(const Polygon &poly, const Varyings &in) const
+{
+    return GetImageColor(in.uv, poly.mp_texture);
+}
+
+LambertShader::LambertShader(glm::vec4 lightDir, float albedo, float ambient)
+    : lightDir(glm::normalize(lightDir)), albedo(albedo), ambient(ambient)
+{}
+
+glm::vec3 LambertShader::Shade(const Polygon &poly, const Varyings &in, float visibility) const
+{
+    glm::vec3 color = GetImageColor(in.uv, poly.mp_texture);
+    float attenuate = visibility * glm::clamp(glm::dot(in.normal, lightDir), 0.f, 1.f);
+    return albedo * (attenuate + ambient) * color;
+}
+
+ToonShader::ToonShader(glm::vec4 lightDir, float albedo, float ambient, int numTones)
+    : lightDir(glm::normalize(lightDir)), albedo(albedo), ambient(ambient), numTones(numTones)
+{}
+
+glm::vec3 ToonShader::Shade(const Polygon &poly, const Varyings &in, float visibility) const
+{
+    glm::vec3 color = GetImageColor(in.uv, poly.mp_texture);
+    float attenuate = visibility * glm::clamp(glm::dot(in.normal, lightDir), 0.f, 1.f);
+    float quantized = std::round(attenuate * numTones) / numTones;
+    return color * (albedo * (quantized + ambient));
+}
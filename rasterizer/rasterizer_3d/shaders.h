@@ -0,0 +1,104 @@
+#pragma once
+#include <polygon.h>
+#include <shadowmap.h>
+
+// Fragment shaders used by the Rasterizer.
+// Each shader declares the Varyings it reads. The Rasterizer builds one
+// Varyings per triangle corner with Varyings::FromVertex() and interpolates
+// exactly those fields per pixel, so attributes a shader does not declare
+// cost nothing. A Varyings struct must provide FromVertex(), operator+ and
+// operator* (by a float weight).
+
+// Perspective-correct interpolation of the varyings of a triangle.
+// weight is the output of Polygon::GetBarycentricWeight(), whose components
+// are already divided by each corner's depth, and z is 1 / (sum of weights).
+template<typename V>
+inline V InterpolateVaryings(const V (&corners)[3], const glm::vec3 &weight, float z)
+{
+    return corners[0] * (weight.x * z) + corners[1] * (weight.y * z) + corners[2] * (weight.z * z);
+}
+
+// Texture color only
+class UnlitShader
+{
+public:
+    struct Varyings
+    {
+        glm::vec2 uv;
+
+        static Varyings FromVertex(const Vertex &v) { return {v.m_uv}; }
+        Varyings operator+(const Varyings &o) const { return {uv + o.uv}; }
+        Varyings operator*(float w) const { return {uv * w}; }
+    };
+
+    glm::vec3 Shade(const Polygon &poly, const Varyings &in) const;
+};
+
+// Texture color attenuated by the angle between the normal and the light
+class LambertShader
+{
+public:
+    struct Varyings
+    {
+        glm::vec2 uv;
+        glm::vec4 normal;
+
+        static Varyings FromVertex(const Vertex &v) { return {v.m_uv, v.m_normal}; }
+        Varyings operator+(const Varyings &o) const { return {uv + o.uv, normal + o.normal}; }
+        Varyings operator*(float w) const { return {uv * w, normal * w}; }
+    };
+
+    LambertShader(glm::vec4 lightDir, float albedo, float ambient);
+
+    // visibility scales the diffuse term, see ShadowedShader
+    glm::vec3 Shade(const Polygon &poly, const Varyings &in, float visibility = 1.f) const;
+
+    glm::vec4 lightDir;
+    float albedo;
+    float ambient;
+};
+
+// Lambertian shading quantized to a fixed number of tones
+class ToonShader
+{
+public:
+    typedef LambertShader::Varyings Varyings;
+
+    ToonShader(glm::vec4 lightDir, float albedo, float ambient, int numTones);
+
+    glm::vec3 Shade(const Polygon &poly, const Varyings &in, float visibility = 1.f) const;
+
+    glm::vec4 lightDir;
+    float albedo;
+    float ambient;
+    int numTones;
+};
+
+// Wraps a lit shader and darkens the pixels that the ShadowMap's light cannot see.
+// Adds the world-space position to the varyings of the wrapped shader.
+template<typename Lit>
+class ShadowedShader
+{
+public:
+    struct Varyings
+    {
+        typename Lit::Varyings lit;
+        glm::vec4 pos;
+
+        static Varyings FromVertex(const Vertex &v) { return {Lit::Varyings::FromVertex(v), v.m_pos}; }
+        Varyings operator+(const Varyings &o) const { return {lit + o.lit, pos + o.pos}; }
+        Varyings operator*(float w) const { return {lit * w, pos * w}; }
+    };
+
+    ShadowedShader(const Lit &shader, const ShadowMap &shadowMap)
+        : shader(shader), shadowMap(shadowMap)
+    {}
+
+    glm::vec3 Shade(const Polygon &poly, const Varyings &in) const
+    {
+        return shader.Shade(poly, in.lit, shadowMap.Visibility(in.pos));
+    }
+
+    Lit shader;
+    const ShadowMap &shadowMap;
+};
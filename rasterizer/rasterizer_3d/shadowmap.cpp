@@ -0,0 +1,33 @@
+#include "shadowmap.h"
+#include <limits>
+
+ShadowMap::ShadowMap(int resolution, const glm::mat4 &lightViewProj, bool tiled)
+    : resolution(resolution), lightViewProj(lightViewProj),
+      depth(resolution, resolution, tiled, std::numeric_limits<float>::infinity()),
+      bias(1e-3f)
+{}
+
+float ShadowMap::Visibility(const glm::vec4 &worldPos) const
+{
+    glm::vec4 p = lightViewProj * worldPos;
+    if (p.w <= 0.f) return 1.f;
+    // The light-space z/w of worldPos, the quantity Polygon::GetDepth wrote to the map
+    p = p / p.w;
+
+    // Same NDC -> pixel mapping as Rasterizer::TransformToPixelSpace
+    int x = (int) ((p.x + 1) * resolution / 2);
+    int y = (int) ((1 - p.y) * resolution / 2);
+
+    int lit = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int sx = x + dx;
+            int sy = y + dy;
+            // Everything outside of the light's frustum is lit
+            if (sx < 0 || sy < 0 || sx >= resolution || sy >= resolution || p.z - bias <= depth.At(sx, sy)) {
+                lit++;
+            }
+        }
+    }
+    return lit / 9.f;
+}
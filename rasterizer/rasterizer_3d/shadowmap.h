@@ -0,0 +1,22 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <tiledbuffer.h>
+
+// The depth of the scene as seen from a light, rendered by Rasterizer::RenderDepth.
+// Shaders use it to find out whether a world-space point is lit.
+class ShadowMap
+{
+public:
+    ShadowMap(int resolution, const glm::mat4 &lightViewProj, bool tiled);
+
+    int resolution;
+    glm::mat4 lightViewProj;
+    TiledBuffer<float> depth;
+
+    // Depth offset that keeps a surface from shadowing itself
+    float bias;
+
+    // Percentage-closer filtering: the fraction of the 3x3 shadow map texels
+    // around the projection of worldPos from which the light is visible
+    float Visibility(const glm::vec4 &worldPos) const;
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <vector>
+#include <cstring>
+#include <QImage>
+
+#ifdef TILEDBUFFER_TRACE
+// Called with the address of every texel the Rasterizer reads or writes, so that
+// rasterbench can run its cache model over the framebuffer traffic of a frame
+void TiledBufferTrace(const void *texel);
+#define TILEDBUFFER_TOUCH(texel) TiledBufferTrace(texel)
+#else
+#define TILEDBUFFER_TOUCH(texel)
+#endif
+
+// A width x height buffer of T used as a render target by the Rasterizer.
+// In linear mode texels are stored row-major like a QImage. In tiled mode the
+// buffer is split into 8x8 tiles stored one after the other, and the 64 texels
+// of a tile are ordered along a Morton (Z-order) curve, so a pixel and its
+// neighbours in both x and y usually share a cache line.
+template<typename T>
+class TiledBuffer
+{
+public:
+    static const int TILE_SIZE = 8;
+    static const int TILE_TEXELS = TILE_SIZE * TILE_SIZE;
+
+    TiledBuffer(int width, int height, bool tiled, T clear)
+        : m_width(width), m_height(height), m_tiled(tiled),
+          m_tilesX((width + TILE_SIZE - 1) / TILE_SIZE),
+          m_tilesY((height + TILE_SIZE - 1) / TILE_SIZE),
+          m_data(tiled ? m_tilesX * m_tilesY * TILE_TEXELS : width * height, clear)
+    {}
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    bool IsTiled() const { return m_tiled; }
+
+    // The part of a texel's address that only depends on its row.
+    // Compute it once per scanline and pass it to Offset() for every column.
+    int RowBase(int y) const
+    {
+        if (!m_tiled) return y * m_width;
+        return (y / TILE_SIZE) * m_tilesX * TILE_TEXELS + (SpreadBits(y % TILE_SIZE) << 1);
+    }
+
+    int Offset(int rowBase, int x) const
+    {
+        if (!m_tiled) return rowBase + x;
+        return rowBase + (x / TILE_SIZE) * TILE_TEXELS + SpreadBits(x % TILE_SIZE);
+    }
+
+    int Index(int x, int y) const { return Offset(RowBase(y), x); }
+
+    T& operator[](int idx) { TILEDBUFFER_TOUCH(&m_data[idx]); return m_data[idx]; }
+    const T& operator[](int idx) const { TILEDBUFFER_TOUCH(&m_data[idx]); return m_data[idx]; }
+
+    T& At(int x, int y) { return (*this)[Index(x, y)]; }
+    const T& At(int x, int y) const { return (*this)[Index(x, y)]; }
+
+    // Linearizes the buffer into a row-major image of the same size.
+    // Only meaningful for buffers of QRgb.
+    void Resolve(QImage &image) const
+    {
+        if (!m_tiled) {
+            for (int y = 0; y < m_height; y++) {
+                for (int x = 0; x < m_width; x++) TILEDBUFFER_TOUCH(&m_data[y * m_width + x]);
+                std::memcpy(image.scanLine(y), &m_data[y * m_width], m_width * sizeof(T));
+            }
+            return;
+        }
+        // Copy a tile at a time rather than a row at a time: one row of a 2048 wide
+        // buffer touches two cache lines in each of its 256 tiles, which is all of L1
+        for (int y0 = 0; y0 < m_height; y0 += TILE_SIZE) {
+            int rows = m_height - y0 < TILE_SIZE ? m_height - y0 : TILE_SIZE;
+            for (int x0 = 0; x0 < m_width; x0 += TILE_SIZE) {
+                int cols = m_width - x0 < TILE_SIZE ? m_width - x0 : TILE_SIZE;
+                int tileBase = Index(x0, y0);
+                for (int y = 0; y < rows; y++) {
+                    T *dst = reinterpret_cast<T*>(image.scanLine(y0 + y)) + x0;
+                    int rowBase = tileBase + (SpreadBits(y) << 1);
+                    for (int x = 0; x < cols; x++) {
+                        dst[x] = (*this)[rowBase + SpreadBits(x)];
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    // Interleaves the three low bits of v with zeros: 0b abc -> 0b a0b0c
+    static int SpreadBits(int v)
+    {
+        static const int table[TILE_SIZE] = {0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15};
+        return table[v];
+    }
+
+    int m_width;
+    int m_height;
+    bool m_tiled;
+    int m_tilesX;
+    int m_tilesY;
+    std::vector<T> m_data;
+};